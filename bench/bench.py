@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#
+# @file      bench.py
+# @version   1.0
+# @date      Sun, 18 Oct 2026 19:31:40 -0300
+# @brief     Simulator throughput benchmark of the ArchC POWERPC model.
+#
+# Copyright (C) 2002-2026 --- The ArchC Team
+#
+# Builds the guest programs in this directory with a PowerPC cross
+# compiler and runs them on one or more simulator builds, reporting
+# guest MIPS and host nanoseconds per guest instruction for every
+# behavior family (micro.c) and kernel (kernels.c).
+#
+#   bench.py --sim standalone=../powerpc.x
+#   bench.py --sim standalone=../powerpc.x \
+#            --sim block='../platform/block.x --load={guest} {args}'
+#
+# The instruction count is the one ArchC prints at the end of the run.
+
+import argparse
+import csv
+import os
+import re
+import shlex
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+MICRO = ["add", "rlwinm", "lwz_stw", "lbz_sth", "lmw_stmw", "mullw", "divw",
+         "bc", "cr", "spr", "call"]
+KERNELS = ["crc32", "bitcount", "qsort", "stringsearch", "basicmath"]
+
+# Iterations giving tens of millions of guest instructions at scale 1
+MICRO_ITERATIONS = 2000000
+KERNEL_REPETITIONS = {"crc32": 1000, "bitcount": 400, "qsort": 40,
+                      "stringsearch": 300, "basicmath": 100}
+
+INSTRUCTIONS = re.compile(r"instructions executed:\s*(\d+)", re.IGNORECASE)
+
+
+def build_guests(cc, cflags, outdir):
+    """Compiles micro.c and kernels.c, returns {name: path}."""
+    os.makedirs(outdir, exist_ok=True)
+    guests = {}
+    for name in ("micro", "kernels"):
+        src = os.path.join(HERE, name + ".c")
+        exe = os.path.join(outdir, name + ".x")
+        if not os.path.exists(exe) or os.path.getmtime(exe) < os.path.getmtime(src):
+            cmd = [cc] + shlex.split(cflags) + [src, "-o", exe]
+            if subprocess.call(cmd) != 0:
+                sys.exit("bench: cannot build %s with: %s" % (name, " ".join(cmd)))
+        guests[name] = exe
+    return guests
+
+
+def workloads(guests, scale, only=None):
+    """Returns (name, guest, args) tuples of the suite."""
+    w = [("micro/" + f, guests["micro"], [f, str(int(MICRO_ITERATIONS * scale))])
+         for f in MICRO]
+    w += [("kernel/" + k, guests["kernels"], [k, str(max(1, int(KERNEL_REPETITIONS[k] * scale)))])
+          for k in KERNELS]
+    if only:
+        w = [x for x in w if any(re.search(o, x[0]) for o in only)]
+    return w
+
+
+def command(sim, guest, args):
+    """Simulator command line. sim may hold {guest} and {args} fields,
+    otherwise --load=<guest> <args> is appended."""
+    if "{guest}" in sim:
+        return shlex.split(sim.replace("{guest}", guest).replace("{args}", " ".join(args)))
+    return shlex.split(sim) + ["--load=" + guest] + args
+
+
+def run_once(cmd, env=None):
+    """Runs cmd, returns seconds, instructions (None if not printed) and
+    maximum RSS in KiB of that process only."""
+    start = time.perf_counter()
+    p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, env=env)
+    out = p.stdout.read()
+    _, status, usage = os.wait4(p.pid, 0)
+    seconds = time.perf_counter() - start
+    text = out.decode("utf-8", "replace")
+    m = INSTRUCTIONS.search(text)
+    return {"seconds": seconds,
+            "instructions": int(m.group(1)) if m else None,
+            "rss_kb": usage.ru_maxrss,
+            "status": os.waitstatus_to_exitcode(status),
+            "output": text}
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Simulator throughput benchmark")
+    ap.add_argument("--sim", action="append", required=True, metavar="NAME=CMD",
+                    help="simulator build to measure, e.g. standalone=./powerpc.x")
+    ap.add_argument("--cc", default=os.environ.get("CROSS_CC", "powerpc-elf-gcc"))
+    ap.add_argument("--cflags", default=os.environ.get("CROSS_CFLAGS", "-O2 -specs=archc"))
+    ap.add_argument("--build", default=os.path.join(HERE, "build"))
+    ap.add_argument("--scale", type=float, default=1.0, help="multiplies the workload sizes")
+    ap.add_argument("--only", action="append", help="regex of workloads to run")
+    ap.add_argument("--csv", help="also write the results to this file")
+    a = ap.parse_args()
+
+    guests = build_guests(a.cc, a.cflags, a.build)
+    rows = []
+
+    print("%-10s %-22s %14s %9s %9s %10s" % ("build", "workload", "instructions", "seconds", "MIPS", "ns/insn"))
+    for spec in a.sim:
+        name, _, sim = spec.partition("=")
+        for wname, guest, args in workloads(guests, a.scale, a.only):
+            r = run_once(command(sim, guest, args))
+            if r["status"] != 0 or not r["instructions"]:
+                print("%-10s %-22s failed (status %s)" % (name, wname, r["status"]))
+                sys.stderr.write(r["output"][-2000:])
+                continue
+            mips = r["instructions"] / r["seconds"] / 1e6
+            rows.append({"build": name, "workload": wname, "instructions": r["instructions"],
+                         "seconds": "%.4f" % r["seconds"], "mips": "%.2f" % mips,
+                         "ns_per_insn": "%.2f" % (1e9 * r["seconds"] / r["instructions"]),
+                         "rss_kb": r["rss_kb"]})
+            print("%-10s %-22s %14d %9.3f %9.2f %10.2f" % (name, wname, r["instructions"], r["seconds"],
+                                                          mips, 1e9 * r["seconds"] / r["instructions"]))
+
+    if a.csv and rows:
+        with open(a.csv, "w", newline="") as f:
+            w = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+            w.writeheader()
+            w.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
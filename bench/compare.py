@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# @file      compare.py
+# @version   1.0
+# @date      Sun, 18 Oct 2026 20:02:18 -0300
+# @brief     Performance regression check between two simulator builds.
+#
+# Copyright (C) 2002-2026 --- The ArchC Team
+#
+# Runs the bench.py workloads on a baseline and a candidate simulator,
+# alternating builds run by run so host noise affects both alike, and
+# compares MIPS, maximum RSS and startup time (a run of zero loop
+# iterations). A difference is flagged when Welch's t-test rejects
+# equal means at the 95% level and the change is worse than --threshold.
+# The exit status is 1 if any regression is flagged.
+#
+#   compare.py --base ./old/powerpc.x --new ./powerpc.x --runs 10
+
+import argparse
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import bench
+
+# Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+T95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+def t95(df):
+    if df < 1:
+        return float("inf")
+    if df >= len(T95):
+        return 1.960 + (T95[-1] - 1.960) * len(T95) / df
+    lo = int(df)
+    hi = min(lo + 1, len(T95))
+    return T95[lo - 1] + (T95[hi - 1] - T95[lo - 1]) * (df - lo)
+
+
+def stats(xs):
+    """Mean, sample variance and 95% confidence half-width."""
+    n = len(xs)
+    mean = sum(xs) / n
+    var = sum((x - mean) ** 2 for x in xs) / (n - 1) if n > 1 else 0.0
+    return mean, var, t95(n - 1) * math.sqrt(var / n) if n > 1 else float("inf")
+
+
+def welch(a, b):
+    """True if the means of a and b differ at the 95% level."""
+    ma, va, _ = stats(a)
+    mb, vb, _ = stats(b)
+    se2 = va / len(a) + vb / len(b)
+    if se2 == 0.0:
+        return ma != mb
+    df = se2 ** 2 / ((va / len(a)) ** 2 / (len(a) - 1) + (vb / len(b)) ** 2 / (len(b) - 1))
+    return abs(ma - mb) / math.sqrt(se2) > t95(df)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Simulator performance regression check")
+    ap.add_argument("--base", required=True, help="baseline simulator command")
+    ap.add_argument("--new", required=True, help="candidate simulator command")
+    ap.add_argument("--runs", type=int, default=10)
+    ap.add_argument("--threshold", type=float, default=3.0,
+                    help="smallest change in percent worth flagging")
+    ap.add_argument("--cc", default=os.environ.get("CROSS_CC", "powerpc-elf-gcc"))
+    ap.add_argument("--cflags", default=os.environ.get("CROSS_CFLAGS", "-O2 -specs=archc"))
+    ap.add_argument("--build", default=os.path.join(bench.HERE, "build"))
+    ap.add_argument("--scale", type=float, default=0.25)
+    ap.add_argument("--only", action="append", help="regex of workloads to run")
+    a = ap.parse_args()
+
+    if a.runs < 2:
+        sys.exit("compare: at least 2 runs are needed")
+
+    guests = bench.build_guests(a.cc, a.cflags, a.build)
+    suite = bench.workloads(guests, a.scale, a.only)
+    suite.append(("startup", guests["micro"], ["add", "0"]))
+    builds = (("base", a.base), ("new", a.new))
+
+    # metric -> workload -> build -> samples; higher_is_better per metric
+    metrics = {"MIPS": True, "RSS KiB": False, "startup s": False}
+    samples = dict((m, {}) for m in metrics)
+
+    for run in range(a.runs):
+        for wname, guest, args in suite:
+            order = builds if run % 2 == 0 else builds[::-1]
+            for bname, sim in order:
+                r = bench.run_once(bench.command(sim, guest, args))
+                if r["status"] != 0:
+                    sys.stderr.write(r["output"][-2000:])
+                    sys.exit("compare: %s failed on %s (status %s)" % (bname, wname, r["status"]))
+                if wname == "startup":
+                    samples["startup s"].setdefault(wname, {}).setdefault(bname, []).append(r["seconds"])
+                    continue
+                if not r["instructions"]:
+                    sys.exit("compare: %s printed no instruction count on %s" % (bname, wname))
+                samples["MIPS"].setdefault(wname, {}).setdefault(bname, []).append(
+                    r["instructions"] / r["seconds"] / 1e6)
+                samples["RSS KiB"].setdefault(wname, {}).setdefault(bname, []).append(r["rss_kb"])
+        sys.stderr.write("compare: run %d/%d done\n" % (run + 1, a.runs))
+
+    regressions = 0
+    print("%-10s %-22s %14s %14s %8s  %s" % ("metric", "workload", "base", "new", "change", "verdict"))
+    for metric, higher_is_better in metrics.items():
+        for wname, by_build in samples[metric].items():
+            mb, _, cb = stats(by_build["base"])
+            mn, _, cn = stats(by_build["new"])
+            change = 100.0 * (mn - mb) / mb if mb else 0.0
+            worse = -change if higher_is_better else change
+            verdict = ""
+            if welch(by_build["base"], by_build["new"]) and abs(change) >= a.threshold:
+                verdict = "REGRESSION" if worse > 0 else "improvement"
+                regressions += worse > 0
+            print("%-10s %-22s %8.3g+-%-5.2g %8.3g+-%-5.2g %+7.1f%%  %s" %
+                  (metric, wname, mb, cb, mn, cn, change, verdict))
+
+    if regressions:
+        print("%d regression(s) flagged" % regressions)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
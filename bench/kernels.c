@@ -0,0 +1,170 @@
+/**
+ * @file      kernels.c
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ * @version   1.0
+ * @date      Sun, 18 Oct 2026 19:05:12 -0300
+ *
+ * @brief     Small MiBench-like guest kernels for simulator throughput.
+ *
+ * @attention Copyright (C) 2002-2026 --- The ArchC Team
+ *
+ * Usage: kernels <kernel> <repetitions>
+ *
+ * The kernels follow MiBench's crc32, bitcount, qsort, stringsearch and
+ * basicmath (integer square root) on built-in data, so no input files
+ * are needed. Each prints a checksum so runs can be checked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DATA_SIZE 4096
+
+static unsigned char data[DATA_SIZE];
+
+static void fill(unsigned int seed) {
+  unsigned int i;
+  for (i = 0; i < DATA_SIZE; i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = seed >> 16;
+  }
+}
+
+static unsigned int crc32(unsigned int reps) {
+  static unsigned int table[256];
+  unsigned int i, j, c, crc = 0;
+
+  for (i = 0; i < 256; i++) {
+    for (c = i, j = 0; j < 8; j++)
+      c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+    table[i] = c;
+  }
+  while (reps--) {
+    crc = ~0U;
+    for (i = 0; i < DATA_SIZE; i++)
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    crc = ~crc;
+  }
+  return crc;
+}
+
+static unsigned int bitcount(unsigned int reps) {
+  unsigned int i, x, n = 0;
+
+  while (reps--)
+    for (i = 0; i < DATA_SIZE; i += 4) {
+      x = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (data[i + 3] << 24);
+      x = x - ((x >> 1) & 0x55555555);
+      x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+      n += (((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+      for (x ^= i; x; x &= x - 1)
+        n++;
+    }
+  return n;
+}
+
+static int compare(const void *a, const void *b) {
+  unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+  return x < y ? -1 : x > y;
+}
+
+static unsigned int qsort_kernel(unsigned int reps) {
+  static unsigned int v[DATA_SIZE / 4];
+  unsigned int i, sum = 0;
+
+  while (reps--) {
+    memcpy(v, data, sizeof(v));
+    v[reps % (DATA_SIZE / 4)] ^= reps;
+    qsort(v, DATA_SIZE / 4, sizeof(v[0]), compare);
+    sum += v[0] ^ v[DATA_SIZE / 8];
+  }
+  for (i = 1; i < DATA_SIZE / 4; i++)
+    if (v[i - 1] > v[i])
+      return 0;
+  return sum;
+}
+
+static unsigned int stringsearch(unsigned int reps) {
+  static char text[DATA_SIZE + 1];
+  static const char *patterns[] = { "abc", "zzz", "hello", "qqqqq", "ba", "cab" };
+  unsigned int i, p, found = 0;
+
+  for (i = 0; i < DATA_SIZE; i++)
+    text[i] = 'a' + data[i] % 26;
+  text[DATA_SIZE] = 0;
+
+  while (reps--)
+    for (p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+      const char *s = text;
+      while ((s = strstr(s, patterns[p])) != NULL) {
+        found++;
+        s++;
+      }
+    }
+  return found;
+}
+
+static unsigned int isqrt(unsigned int x) {
+  unsigned int r = 0, b = 1U << 30;
+
+  while (b > x)
+    b >>= 2;
+  while (b) {
+    if (x >= r + b) {
+      x -= r + b;
+      r = (r >> 1) + b;
+    }
+    else
+      r >>= 1;
+    b >>= 2;
+  }
+  return r;
+}
+
+static unsigned int basicmath(unsigned int reps) {
+  unsigned int i, sum = 0;
+
+  while (reps--)
+    for (i = 0; i < DATA_SIZE; i++)
+      sum += isqrt(i * 2654435761U) + (i * 7919) / (data[i] + 1);
+  return sum;
+}
+
+static const struct {
+  const char *name;
+  unsigned int (*run)(unsigned int);
+} kernels[] = {
+  { "crc32", crc32 },
+  { "bitcount", bitcount },
+  { "qsort", qsort_kernel },
+  { "stringsearch", stringsearch },
+  { "basicmath", basicmath },
+};
+
+#define KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+int main(int argc, char **argv) {
+  unsigned int i;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: kernels <kernel> <repetitions>\nkernels:");
+    for (i = 0; i < KERNELS; i++)
+      fprintf(stderr, " %s", kernels[i].name);
+    fprintf(stderr, "\n");
+    return 1;
+  }
+
+  fill(2026);
+  for (i = 0; i < KERNELS; i++)
+    if (strcmp(argv[1], kernels[i].name) == 0) {
+      printf("%s %08x\n", kernels[i].name, kernels[i].run(strtoul(argv[2], NULL, 0)));
+      return 0;
+    }
+
+  fprintf(stderr, "kernels: unknown kernel %s\n", argv[1]);
+  return 1;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file      micro.c
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ * @version   1.0
+ * @date      Sun, 18 Oct 2026 19:05:12 -0300
+ *
+ * @brief     Guest microbenchmarks, one behavior family per loop.
+ *
+ * @attention Copyright (C) 2002-2026 --- The ArchC Team
+ *
+ * Usage: micro <family> <iterations>
+ *
+ * Each iteration runs 16 instructions of the family plus the loop
+ * overhead (addi, cmpw, bc), so the guest instruction count is close to
+ * 19 * iterations. Built with a PowerPC cross compiler by bench.py.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define X4(s)   s s s s
+#define X16(s)  X4(s) X4(s) X4(s) X4(s)
+
+static unsigned int mem[64];
+
+static unsigned int loop_add(unsigned int n) {
+  unsigned int a = 1, b = 3;
+  while (n--)
+    __asm__ volatile(X16("add %0,%0,%1\n\t") : "+r"(a) : "r"(b));
+  return a;
+}
+
+static unsigned int loop_rlwinm(unsigned int n) {
+  unsigned int a = 0x12345678;
+  while (n--)
+    __asm__ volatile(X16("rlwinm %0,%0,3,0,28\n\t") : "+r"(a));
+  return a;
+}
+
+static unsigned int loop_lwz_stw(unsigned int n) {
+  unsigned int a = 7, *p = mem;
+  while (n--)
+    __asm__ volatile(X4("stw %0,0(%1)\n\tlwz %0,0(%1)\n\tstw %0,4(%1)\n\tlwz %0,4(%1)\n\t")
+                     : "+r"(a) : "b"(p) : "memory");
+  return a;
+}
+
+static unsigned int loop_lbz_sth(unsigned int n) {
+  unsigned int a = 7, *p = mem;
+  while (n--)
+    __asm__ volatile(X4("sth %0,0(%1)\n\tlbz %0,1(%1)\n\tstb %0,2(%1)\n\tlhz %0,2(%1)\n\t")
+                     : "+r"(a) : "b"(p) : "memory");
+  return a;
+}
+
+static unsigned int loop_lmw(unsigned int n) {
+  unsigned int *p = mem;
+  while (n--)
+    __asm__ volatile(X4("stmw 28,0(%0)\n\tlmw 28,0(%0)\n\t") X4("nop\n\tnop\n\t")
+                     : : "b"(p) : "r28", "r29", "r30", "r31", "memory");
+  return mem[0];
+}
+
+static unsigned int loop_mullw(unsigned int n) {
+  unsigned int a = 3, b = 5;
+  while (n--)
+    __asm__ volatile(X16("mullw %0,%0,%1\n\t") : "+r"(a) : "r"(b));
+  return a;
+}
+
+static unsigned int loop_divw(unsigned int n) {
+  unsigned int a = 0x7FFFFFFF, b = 3;
+  while (n--)
+    __asm__ volatile(X16("divw %0,%0,%1\n\t") : "+r"(a) : "r"(b));
+  return a;
+}
+
+static unsigned int loop_bc(unsigned int n) {
+  unsigned int a = 1;
+  while (n--)
+    __asm__ volatile(X4("cmpwi %0,0\n\tbne 1f\n\tnop\n1:\n\tbeq 1f\n1:\n\t")
+                     : : "r"(a) : "cr0");
+  return a;
+}
+
+static unsigned int loop_cr(unsigned int n) {
+  while (n--)
+    __asm__ volatile(X16("crxor 6,6,6\n\t") : : : "cr1");
+  return 0;
+}
+
+static unsigned int loop_spr(unsigned int n) {
+  unsigned int a = 5;
+  while (n--)
+    __asm__ volatile(X4("mtctr %0\n\tmfctr %0\n\tmtxer %0\n\tmfxer %0\n\t") : "+r"(a) : : "ctr", "xer");
+  return a;
+}
+
+static unsigned int __attribute__((noinline)) leaf(unsigned int a) {
+  __asm__ volatile("" : "+r"(a));
+  return a + 1;
+}
+
+static unsigned int loop_call(unsigned int n) {
+  unsigned int a = 0;
+  while (n--) {
+    a = leaf(a); a = leaf(a); a = leaf(a); a = leaf(a);
+  }
+  return a;
+}
+
+static const struct {
+  const char *name;
+  unsigned int (*run)(unsigned int);
+} families[] = {
+  { "add", loop_add },
+  { "rlwinm", loop_rlwinm },
+  { "lwz_stw", loop_lwz_stw },
+  { "lbz_sth", loop_lbz_sth },
+  { "lmw_stmw", loop_lmw },
+  { "mullw", loop_mullw },
+  { "divw", loop_divw },
+  { "bc", loop_bc },
+  { "cr", loop_cr },
+  { "spr", loop_spr },
+  { "call", loop_call },
+};
+
+#define FAMILIES (sizeof(families) / sizeof(families[0]))
+
+int main(int argc, char **argv) {
+  unsigned int i, n;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: micro <family> <iterations>\nfamilies:");
+    for (i = 0; i < FAMILIES; i++)
+      fprintf(stderr, " %s", families[i].name);
+    fprintf(stderr, "\n");
+    return 1;
+  }
+
+  n = strtoul(argv[2], NULL, 0);
+  for (i = 0; i < FAMILIES; i++)
+    if (strcmp(argv[1], families[i].name) == 0) {
+      printf("%s %u\n", families[i].name, families[i].run(n));
+      return 0;
+    }
+
+  fprintf(stderr, "micro: unknown family %s\n", argv[1]);
+  return 1;
+}
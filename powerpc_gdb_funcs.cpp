@@ -19,9 +19,24 @@
  */
 
 #include "powerpc.H"
+#include "powerpc_core.H"
+#include "powerpc_snapshot.H"
 
 using namespace powerpc_parms;
 
+//GDB reads memory one byte per call. Bytes are served from a window of
+//aligned words, read again once the core has executed or on a new window.
+#define GDB_WINDOW 256
+
+struct powerpc_gdb_window {
+  bool valid;
+  unsigned int base;
+  unsigned long long instret;   /* Core instructions when filled */
+  unsigned char bytes[GDB_WINDOW];
+};
+
+static powerpc_gdb_window gdb_windows[POWERPC_MAX_CORES];
+
 int powerpc::nRegs(void) {
   return 104;
 }
@@ -59,6 +74,11 @@ ac_word powerpc::reg_read( int reg ) {
         n=XER.read();
       break;
 
+      /* MQ, not in the 405: instructions executed, for reverse debugging */
+      case 102:
+        n=powerpc_core_of(&ac_pc).instret;
+      break;
+
       default:
         return 0;
       break;
@@ -104,6 +124,28 @@ void powerpc::reg_write( int reg, ac_word value ) {
       XER.write(value);
     break;
 
+    /* Writing MQ rewinds to the latest checkpoint at or before that
+       instruction (the low 32 bits of the count, as GDB sees them).
+       Writing back the current count, as a whole-file 'G' packet does,
+       changes nothing. */
+    case 102: {
+      powerpc_core &core=powerpc_core_of(&ac_pc);
+      unsigned long long target=(core.instret & ~0xFFFFFFFFULL) | (unsigned int)value;
+
+      if ( target > core.instret )
+        target-=1ULL << 32;
+      if ( target == core.instret )
+        break;
+      if ( core.history == NULL )
+        fprintf(stderr, "powerpc: no checkpoints, set POWERPC_SNAPSHOT to rewind\n");
+      else if ( !core.history->rewind(target, *this, &MEM, core.instret, core.timer, core.events) )
+        fprintf(stderr, "powerpc: no checkpoint left before instruction %llu\n", target);
+      else
+        fprintf(stderr, "powerpc: core %u rewound to instruction %llu, pc 0x%08x\n",
+                core.index, core.instret, (unsigned int)ac_pc);
+    }
+    break;
+
     default:
       /* No completely implemented register */
       break;
@@ -114,11 +156,37 @@ void powerpc::reg_write( int reg, ac_word value ) {
 
 
 unsigned char powerpc::mem_read( unsigned int address ) {
-  return DATA_PORT->read_byte( address );
+
+  powerpc_core &core=powerpc_core_of(&ac_pc);
+  powerpc_gdb_window &w=gdb_windows[core.index];
+  unsigned int base=address & ~(GDB_WINDOW - 1);
+
+  if ( base > AC_RAM_END - GDB_WINDOW )
+    return DATA_PORT->read_byte( address );
+
+  if ( !w.valid || w.base != base || w.instret != core.instret ) {
+    for ( unsigned int i=0; i < GDB_WINDOW; i+=4 ) {
+      unsigned int word=DATA_PORT->read( base + i );
+      w.bytes[i]=word >> 24;
+      w.bytes[i+1]=word >> 16;
+      w.bytes[i+2]=word >> 8;
+      w.bytes[i+3]=word;
+    }
+    w.valid=true;
+    w.base=base;
+    w.instret=core.instret;
+  }
+  return w.bytes[address - base];
 }
 
 
 void powerpc::mem_write( unsigned int address, unsigned char byte ) {
+
+  powerpc_gdb_window &w=gdb_windows[powerpc_core_of(&ac_pc).index];
+
   DATA_PORT->write_byte( address, byte );
+  if ( w.valid && address - w.base < GDB_WINDOW )
+    w.bytes[address - w.base]=byte;
 }
 
+
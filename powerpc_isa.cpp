@@ -42,12 +42,26 @@
 #include  "powerpc_isa.H"
 #include  "powerpc_isa_init.cpp"
 #include  "powerpc_bhv_macros.H"
+#include  "powerpc_core.H"
+#include  "powerpc_timing.H"
+#include  "powerpc_pipeline.H"
+#include  "powerpc_predictor.H"
+#include  "powerpc_energy.H"
+#include  "powerpc_profile.H"
+#include  "powerpc_mix.H"
+#include  "powerpc_bbv.H"
+#include  "powerpc_trace.H"
+#include  "powerpc_plugin.H"
+#include  "powerpc_callgraph.H"
+#include  "powerpc_reuse.H"
+#include  "powerpc_watch.H"
+#include  "powerpc_snapshot.H"
+#include  "powerpc_session.H"
 
 //If you want debug information for this model, uncomment next line
 //#define DEBUG_MODEL
 #include  "ac_debug_model.H"
 
-#define DEFAULT_STACK_SIZE (512 * 1024)
 static int processors_started = 0;
 
 using namespace powerpc_parms;
@@ -179,7 +193,8 @@ inline void divwu_XER_OV_SO_update(ac_reg<ac_word> &XER, int result,int s1,int s
 
 
 //Function to do_branch
-inline void do_Branch(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, signed int ili,unsigned int iaa,unsigned int ilk) {
+inline void do_Branch(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, signed int ili,unsigned int iaa,unsigned int ilk,
+		      powerpc_branch &br) {
   
   int displacement;
   unsigned int nia;
@@ -198,21 +213,43 @@ inline void do_Branch(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, signed int il
   if(ilk==1)
     LR.write(ac_pc+4);
 
+  br.cia=ac_pc;
+  br.target=nia;
+  br.kind=BRANCH_IMM;
+  br.conditional=false;
+  br.taken=true;
+  br.link=(ilk==1);
+  br.hint=false;
+
   ac_pc=nia;
   
 }
 
+//Function to test the branch condition of BO and BI
+//CTR must be decremented before, if BO says so.
+inline int branch_cond(ac_reg<ac_word> &CR, ac_reg<ac_word> &CTR, unsigned int ibo, unsigned int ibi) {
+
+  unsigned int masc;
+
+  masc=0x80000000;
+  masc=masc>>ibi;
+
+  return (((ibo & 0x04) || /* Branch */
+	   ((CTR.read()==0) && (ibo & 0x02)) || 
+	   (!(CTR.read()==0) && !(ibo & 0x02)))
+	  && 
+	  ((ibo & 0x10) ||
+	   (((CR.read() & masc) && (ibo & 0x08)) ||
+	    (!(CR.read() & masc) && !(ibo & 0x08)))));
+}
+
 //Function to do conditional branch
 inline void do_Branch_Cond(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, ac_reg<ac_word> &CR, ac_reg<ac_word> &CTR,  unsigned int ibo,unsigned int ibi,
 		    signed int ibd,unsigned int iaa,
-		    unsigned int ilk) {
+		    unsigned int ilk, powerpc_branch &br) {
   
   int displacement;
   unsigned int nia;
-  unsigned int masc;
-
-  masc=0x80000000;
-  masc=masc>>ibi;
 
   ac_pc-=4; /* Because pre-increment */
 
@@ -220,104 +257,92 @@ inline void do_Branch_Cond(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, ac_reg<a
     CTR.write(CTR.read()-1);
   }
 
-  if(((ibo & 0x04) || /* Branch */
-      ((CTR.read()==0) && (ibo & 0x02)) || 
-      (!(CTR.read()==0) && !(ibo & 0x02)))
-     && 
-     ((ibo & 0x10) ||
-      (((CR.read() & masc) && (ibo & 0x08)) ||
-       (!(CR.read() & masc) && !(ibo & 0x08))))) {
+  displacement=ibd<<2;
+  if(iaa == 1)
+    br.target=displacement;
+  else
+    br.target=ac_pc+displacement;
 
-    if(iaa == 1) {
-      displacement=ibd<<2;
-      nia=displacement;
-    }
-    else {
-      displacement=ibd<<2;
-      nia=ac_pc+displacement;
-    }
-  }
-  else { /* No branch */
+  br.taken=branch_cond(CR, CTR, ibo, ibi);
+
+  if(br.taken)
+    nia=br.target;
+  else /* No branch */
     nia=ac_pc+4;
-  }
 
   if(ilk==1)
     LR.write(ac_pc+4);
   
+  br.cia=ac_pc;
+  br.kind=BRANCH_IMM;
+  br.conditional=((ibo & 0x14) != 0x14);
+  br.link=(ilk==1);
+  br.hint=((ibo & 0x01) != 0);
+
   ac_pc=nia;
   
 }
 
 //Function to do conditional branch to count register
 inline void do_Branch_Cond_Count_Reg(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, ac_reg<ac_word> &CR, ac_reg<ac_word> &CTR, unsigned int ibo, unsigned int ibi,
-			      unsigned int ilk) {
+			      unsigned int ilk, powerpc_branch &br) {
 
   unsigned int nia;
-  unsigned int masc;
-
-  masc=0x80000000;
-  masc=masc>>ibi;
 
   ac_pc-=4; /* Because pre-increment */
   
   if((ibo & 0x04) == 0x00)
     CTR.write(CTR.read()-1);
   
-  if(((ibo & 0x04) || /* Branch */
-      ((CTR.read()==0) && (ibo & 0x02)) || 
-      (!(CTR.read()==0) && !(ibo & 0x02)))
-     && 
-     ((ibo & 0x10) ||
-      (((CR.read() & masc) && (ibo & 0x08)) ||
-       (!(CR.read() & masc) && !(ibo & 0x08))))) {
-    
-    nia=CTR.read() & 0xFFFFFFFC;
+  br.target=CTR.read() & 0xFFFFFFFC;
+  br.taken=branch_cond(CR, CTR, ibo, ibi);
 
-  }
-  else { /* No Branch */
+  if(br.taken)
+    nia=br.target;
+  else /* No Branch */
     nia=ac_pc+4;
-  }
 
   if(ilk==1)
     LR.write(ac_pc+4);
   
+  br.cia=ac_pc;
+  br.kind=BRANCH_CTR;
+  br.conditional=((ibo & 0x14) != 0x14);
+  br.link=(ilk==1);
+  br.hint=((ibo & 0x01) != 0);
+
   ac_pc=nia;
 
 }
 
 //Function to do conditional branch to link register
 inline void do_Branch_Cond_Link_Reg(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &LR, ac_reg<ac_word> &CR, ac_reg<ac_word> &CTR,unsigned int ibo,unsigned int ibi,
-			     unsigned int ilk) {
+			     unsigned int ilk, powerpc_branch &br) {
   
   unsigned int nia;
-  unsigned int masc;
-
-  masc=0x80000000;
-  masc=masc>>ibi;
 
   ac_pc-=4; /* Because pre-increment */
   
   if((ibo & 0x04) == 0x00)
     CTR.write(CTR.read()-1);
   
-  if(((ibo & 0x04) || /* Branch */
-      ((CTR.read()==0) && (ibo & 0x02)) || 
-      (!(CTR.read()==0) && !(ibo & 0x02)))
-     && 
-     ((ibo & 0x10) ||
-      (((CR.read() & masc) && (ibo & 0x08)) ||
-       (!(CR.read() & masc) && !(ibo & 0x08))))) {
-    
-    nia=LR.read() & 0xFFFFFFFC;
+  br.target=LR.read() & 0xFFFFFFFC;
+  br.taken=branch_cond(CR, CTR, ibo, ibi);
 
-  }
-  else { /* No Branch */
+  if(br.taken)
+    nia=br.target;
+  else /* No Branch */
     nia=ac_pc+4;
-  }
 
   if(ilk==1)
     LR.write(ac_pc+4);
   
+  br.cia=ac_pc;
+  br.kind=BRANCH_LR;
+  br.conditional=((ibo & 0x14) != 0x14);
+  br.link=(ilk==1);
+  br.hint=((ibo & 0x01) != 0);
+
   ac_pc=nia;
 
 }
@@ -358,13 +383,10 @@ inline int ceil(int value, int divisor) {
   return res;
 }
 
-//Rotl function
+//Rotl function. Both shifts stay below 32: a shift by 32 is undefined,
+//and n is 0 for rlwinm with SH=0 and for rlwnm with the low bits of RB clear.
 inline unsigned int rotl(unsigned int reg,unsigned int n) {
-  unsigned int tmp1=reg;
-  unsigned int tmp2=reg;
-  unsigned int rotated=(tmp1 << n) | (tmp2 >> (32-n));
- 
-  return(rotated);
+  return (reg << (n & 31)) | (reg >> ((32-n) & 31));
 }
 
 //Mask32rlw function
@@ -437,6 +459,285 @@ inline void dumpREG(ac_reg<ac_word> &XER, ac_reg<ac_word> &CR, ac_reg<ac_word> &
 }
 
 
+//Function to take a pending timer interrupt
+//The interrupt is taken only if it is enabled in TCR and MSR.EE is set.
+//ac_pc already holds the address of the next instruction, which is the
+//return address saved in SRR0. Returns true if the interrupt was taken.
+inline bool timer_interrupt(ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &MSR, ac_reg<ac_word> &SRR0, ac_reg<ac_word> &SRR1,
+			    ac_reg<ac_word> &EVPR, ac_reg<ac_word> &TCR, ac_reg<ac_word> &TSR) {
+
+  unsigned int vector;
+
+  if(!(MSR.read() & MSR_EE))
+    return false;
+
+  if((TSR.read() & TSR_PIS) && (TCR.read() & TCR_PIE))
+    vector=VECTOR_PIT;
+  else if((TSR.read() & TSR_FIS) && (TCR.read() & TCR_FIE))
+    vector=VECTOR_FIT;
+  else
+    return false;
+
+  dbg_printf("Timer interrupt at %#x, vector %#x\n",(int)ac_pc,vector);
+
+  SRR0.write(ac_pc);
+  SRR1.write(MSR.read());
+  MSR.write(MSR.read() & ~(MSR_WE | MSR_EE | MSR_PR | MSR_IR | MSR_DR));
+
+  ac_pc=(EVPR.read() & 0xFFFF0000) | vector;
+  return true;
+}
+
+//Function called when sc, rfi or an interrupt redirects the PC: the
+//block models see it as the end of a block
+inline void redirect_event(powerpc_core &core, unsigned int target) {
+
+  if(core.bbv)
+    core.bbv->redirect(target, core.instret);
+}
+
+//Function to get the cycles elapsed on a core: the pipeline model cycles
+//in timing mode, the timing table sum if one is loaded, one per retired
+//instruction otherwise
+inline unsigned long long core_cycles(powerpc_core &core) {
+
+  if(core.pipeline)
+    return core.pipeline->cycle;
+  return core.timing ? core.cycles : core.instret;
+}
+
+//Guest memory reader for the profiler stack walk. It is given the
+//backing memory, not DATA_PORT, so in the cached builds the walk does not
+//touch the DC statistics or replacement state.
+template <class MEM>
+struct guest_word {
+  MEM *mem;
+  guest_word(MEM *m) : mem(m) {}
+  unsigned int operator()(unsigned int addr) const {
+    return (addr < AC_RAM_END - 4 && !(addr & 3)) ? mem->read(addr) : 0;
+  }
+};
+
+//Function to service the events due on a core
+template <class MEM>
+inline void service_events(powerpc_core &core, ac_reg<ac_word> &ac_pc, ac_reg<ac_word> &MSR, ac_reg<ac_word> &SRR0,
+			   ac_reg<ac_word> &SRR1, ac_reg<ac_word> &EVPR, ac_reg<ac_word> &TCR, ac_reg<ac_word> &TSR,
+			   MEM *mem, unsigned int lr, unsigned int sp) {
+
+  int kind;
+
+  while((kind=core.events.pop(core.instret)) >= 0) {
+    switch(kind) {
+
+      case EVENT_PIT:
+        TSR.write(TSR.read() | TSR_PIS);
+        core.timer.pit_expired(core.events, TCR.read(), core.instret);
+      break;
+
+      case EVENT_FIT:
+        TSR.write(TSR.read() | TSR_FIS);
+        core.timer.fit_schedule(core.events, TCR.read(), core.instret);
+      break;
+
+      case EVENT_ENERGY:
+        core.energy->sample(core.instret, core_cycles(core));
+        core.events.schedule(EVENT_ENERGY, core.instret + core.energy->interval);
+      break;
+
+      case EVENT_PROFILE:
+        core.profiler->sample(ac_pc.read(), lr, sp, guest_word<MEM>(mem));
+        core.events.schedule(EVENT_PROFILE, core.instret + core.profiler->interval);
+      break;
+
+      case EVENT_SNAPSHOT:
+        core.history->pending=true;
+        core.events.schedule(EVENT_SNAPSHOT, core.instret + core.history->interval);
+      break;
+
+      case EVENT_STOP:          /* Handled by the caller, which can stop() */
+      break;
+
+    }
+  }
+
+  if(timer_interrupt(ac_pc, MSR, SRR0, SRR1, EVPR, TCR, TSR) &&
+     (POWERPC_HOOKS & HOOK_BRANCH) && (core.hooks & HOOK_BRANCH))
+    redirect_event(core, ac_pc.read());
+}
+
+/*********************************************************************************/
+/* Core events (timers) are checked only at block boundaries: after branches    */
+/* (end_block) and rfi. Straight-line code just counts retired instructions.    */
+/*********************************************************************************/
+#define test_events() { powerpc_core &core_ev = powerpc_core_of(&ac_pc);       \
+    if (core_ev.instret >= core_ev.events.next_due) {                         \
+      service_events(core_ev, ac_pc, MSR, SRR0, SRR1, EVPR, TCR, TSR,        \
+                     &MEM, LR.read(), GPR.read(1));                           \
+      take_snapshot(core_ev);                                                 \
+      test_stop(core_ev);                                                     \
+    } }
+
+//Checkpoint of the core at a block boundary, when one is due
+#define take_snapshot(core) { if ((core).history && (core).history->pending)  \
+      (core).history->take(*this, (core).instret, (core).timer, (core).events); }
+
+//Normal end of the simulation, with the end behavior, when a model
+//asked for it
+#define test_stop(core) { if ((core).stopping) { (core).stopping = false; stop(1); } }
+
+//Frame allocation (stwu/stwux r1): tracks the stack high-water mark
+#define stack_push(sp) { powerpc_core &core_st = powerpc_core_of(&ac_pc);      \
+    powerpc_stack_push(core_st.stack, core_st.index, (sp)); }
+
+//Block end at a PC redirect that is not a branch: sc, rfi, interrupts
+#define end_redirect() { if (HOOKED(HOOK_BRANCH)) {                           \
+    powerpc_core &core_rd = powerpc_core_of(&ac_pc);                          \
+    if (core_rd.hooks & HOOK_BRANCH)                                          \
+      redirect_event(core_rd, ac_pc.read()); } }
+
+#define test_interrupts() { if (timer_interrupt(ac_pc, MSR, SRR0, SRR1, EVPR, TCR, TSR)) \
+      end_redirect(); }
+
+//Function called by the format behaviors with the operands of the
+//instruction about to execute. low is Rc, or AA and LK for branches.
+//Operands are GPR numbers or REG_*.
+inline void issue_event(powerpc_core &core, unsigned int cia, unsigned int opcd, unsigned int xo, unsigned int low,
+			unsigned int d1, unsigned int d2, unsigned int s1, unsigned int s2, unsigned int s3,
+			unsigned int count) {
+
+  unsigned int cls=powerpc_class(opcd, xo);
+
+  if(core.timing)
+    core.cycles+=powerpc_timing_cycles(core.timing, opcd, xo, low);
+  if(core.plugins)
+    core.plugins->instruction(core.index, cia, opcd, xo, cls);
+  if(core.trace)
+    core.trace->fetch(cia);
+  if(core.mix)
+    core.mix->issue(opcd, xo, low);
+  if(core.reuse)
+    core.reuse->issue(cia);
+  if(core.caches) {
+    bool hit=core.caches->fetch(cia);
+    if(core.pipeline)
+      core.pipeline->issue(hit, cls, d1, d2, s1, s2, s3, count);
+    if(core.energy)
+      core.energy->issue(hit, cls, count);
+  }
+}
+
+//Function called for every data access of the load/store behaviors
+inline void data_event(powerpc_core &core, unsigned int cia, unsigned int ea, unsigned int size, bool store, unsigned int value) {
+
+  if(core.watch && core.watch->page(ea, size) &&
+     core.watch->check(core.index, core.instret, cia, ea, size, store, value)) {
+    core.stopping=true;
+    core.events.schedule(EVENT_STOP, core.instret);
+  }
+
+  if(core.caches) {
+    bool hit=core.caches->data(ea, store);
+    if(core.pipeline)
+      core.pipeline->data_access(store, hit);
+    if(core.energy)
+      core.energy->data_access(store, hit);
+  }
+  if(core.trace)
+    core.trace->data(ea, size, store, value);
+  if(core.reuse)
+    core.reuse->access(ea, size, core.instret);
+  if(core.plugins)
+    core.plugins->memory(core.index, ea, size, store, value);
+}
+
+//Function called after every branch, taken or not
+inline void branch_event(powerpc_core &core, const powerpc_branch &br) {
+
+  bool mispredicted=false;
+
+  if(core.predictor)
+    mispredicted=core.predictor->resolve(br);
+  if(core.pipeline)
+    core.pipeline->branch(br, mispredicted);
+  if(core.bbv)
+    core.bbv->block(br, core.instret);
+  if(core.callgraph)
+    core.callgraph->branch(br, core.instret, core_cycles(core));
+  if(core.plugins)
+    core.plugins->branch(core.index, br);
+}
+
+inline unsigned int data_read(powerpc_core &core, unsigned int cia, unsigned int ea, unsigned int size, unsigned int value) {
+  if((POWERPC_HOOKS & HOOK_DATA) && (core.hooks & HOOK_DATA))
+    data_event(core, cia, ea, size, false, value);
+  return value;
+}
+
+//Called before the store is done, so the checkpoints can save the page
+template <class MEM>
+inline unsigned int data_write(powerpc_core &core, MEM *mem, unsigned int cia, unsigned int ea, unsigned int size,
+                               unsigned int value) {
+  if((POWERPC_HOOKS & HOOK_STORE) && (core.hooks & HOOK_STORE)) {
+    if(core.history)
+      core.history->store(mem, ea, size);
+    if(core.written)
+      core.written->mark(ea, size);
+  }
+  if((POWERPC_HOOKS & HOOK_DATA) && (core.hooks & HOOK_DATA))
+    data_event(core, cia, ea, size, true, value);
+  return value;
+}
+
+//Operand number of the special registers tracked by the issue hook
+inline unsigned int spr_operand(unsigned int sprf) {
+  switch(sprf) {
+    case 0x020: return REG_XER;
+    case 0x100: return REG_LR;
+    case 0x120: return REG_CTR;
+  }
+  return REG_NONE;
+}
+
+/*********************************************************************************/
+/* Model hooks, compiled in by POWERPC_HOOKS (none by default). In an analysis   */
+/* build each one costs a core lookup and a test of core.hooks per use.          */
+/*  insn_issue: format behaviors, with the instruction operands                  */
+/*  DATA_*:     load/store behaviors, wrapping every DATA_PORT access            */
+/*  end_block:  branch behaviors, also where core events are serviced           */
+/* Hooks left out of POWERPC_HOOKS are constant-false tests, and the compiler    */
+/* drops them with their core lookup, leaving only the events.                   */
+/*********************************************************************************/
+#define HOOKED(h) ((POWERPC_HOOKS) & (h))
+
+#define insn_issue(xo, low, d1, d2, s1, s2, s3, count) { if (HOOKED(HOOK_ISSUE)) { \
+    powerpc_core &core_is = powerpc_core_of(&ac_pc);                          \
+    if (core_is.hooks & HOOK_ISSUE)                                           \
+      issue_event(core_is, ac_pc-4, opcd, xo, low, d1, d2, s1, s2, s3, count); } }
+
+#define DATA_READ(ea)           (HOOKED(HOOK_DATA) ? data_read(powerpc_core_of(&ac_pc), ac_pc-4, (ea), 4, DATA_PORT->read(ea)) \
+                                                   : DATA_PORT->read(ea))
+#define DATA_READ_HALF(ea)      (HOOKED(HOOK_DATA) ? data_read(powerpc_core_of(&ac_pc), ac_pc-4, (ea), 2, DATA_PORT->read_half(ea)) \
+                                                   : DATA_PORT->read_half(ea))
+#define DATA_READ_BYTE(ea)      (HOOKED(HOOK_DATA) ? data_read(powerpc_core_of(&ac_pc), ac_pc-4, (ea), 1, DATA_PORT->read_byte(ea)) \
+                                                   : DATA_PORT->read_byte(ea))
+#define DATA_WRITE(ea, v)       DATA_PORT->write((ea), HOOKED(HOOK_DATA | HOOK_STORE) ? \
+                                  data_write(powerpc_core_of(&ac_pc), &MEM, ac_pc-4, (ea), 4, (v)) : (v))
+#define DATA_WRITE_HALF(ea, v)  DATA_PORT->write_half((ea), HOOKED(HOOK_DATA | HOOK_STORE) ? \
+                                  data_write(powerpc_core_of(&ac_pc), &MEM, ac_pc-4, (ea), 2, (v)) : (v))
+#define DATA_WRITE_BYTE(ea, v)  DATA_PORT->write_byte((ea), HOOKED(HOOK_DATA | HOOK_STORE) ? \
+                                  data_write(powerpc_core_of(&ac_pc), &MEM, ac_pc-4, (ea), 1, (v)) : (v))
+
+#define end_block(br) { powerpc_core &core_br = powerpc_core_of(&ac_pc);        \
+    if (HOOKED(HOOK_BRANCH) && (core_br.hooks & HOOK_BRANCH))                 \
+      branch_event(core_br, br);                                              \
+    if (core_br.instret >= core_br.events.next_due) {                         \
+      service_events(core_br, ac_pc, MSR, SRR0, SRR1, EVPR, TCR, TSR,        \
+                     &MEM, LR.read(), GPR.read(1));                           \
+      take_snapshot(core_br);                                                 \
+      test_stop(core_br);                                                     \
+    } }
+
+
 
 //!Generic instruction behavior method.
 void ac_behavior( instruction )
@@ -445,6 +746,7 @@ void ac_behavior( instruction )
   test_sleep();
 
   dbg_printf("\n program counter=%#x\n",(int)ac_pc);
+  powerpc_core_of(&ac_pc).instret++;
   ac_pc+=4;
   //dumpGPR();
   //dumpREG();
@@ -454,10 +756,189 @@ void ac_behavior( instruction )
 void ac_behavior( begin )
 {
   dbg_printf("Starting simulator...\n");
+
+  /* Stack of this core, below the ones of the cores started before */
+  {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    powerpc_stack_allocate(core.stack, core.index, AC_RAM_END,
+                           powerpc_stack_size(getenv("POWERPC_STACK_SIZE"), core.index));
+  }
+
+  /* Instruction timing table, shared by all cores */
+  if(getenv("POWERPC_TIMING") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    if(processors_started == 0) {
+      int n=powerpc_load_timing(getenv("POWERPC_TIMING"), powerpc_timing_table());
+      if(n < 0) {
+        fprintf(stderr, "powerpc: cannot read timing table %s\n", getenv("POWERPC_TIMING"));
+        exit(-1);
+      }
+      dbg_printf("Timing table %s: %d instructions\n", getenv("POWERPC_TIMING"), n);
+    }
+    core.timing=powerpc_timing_table();
+    powerpc_enable_hooks(core, HOOK_ISSUE, "POWERPC_TIMING");
+  }
   
+  /* Cycle-approximate PPC405 pipeline timing mode */
+  if(getenv("POWERPC_PIPELINE") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    core.caches=new powerpc_caches();
+    core.pipeline=new powerpc_pipeline();
+    powerpc_enable_hooks(core, HOOK_ISSUE | HOOK_DATA | HOOK_BRANCH, "POWERPC_PIPELINE");
+  }
+
+  /* Branch prediction, PPC405 static scheme by default in timing mode */
+  if(getenv("POWERPC_PREDICTOR") != NULL || getenv("POWERPC_PIPELINE") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    const char *spec=getenv("POWERPC_PREDICTOR") ? getenv("POWERPC_PREDICTOR") : "btfn";
+    powerpc_predictor *dir=powerpc_predictor_create(spec);
+    if(dir == NULL) {
+      fprintf(stderr, "powerpc: unknown branch predictor %s\n", spec);
+      exit(-1);
+    }
+    core.predictor=new powerpc_branch_unit(dir, getenv("POWERPC_RAS") ? atoi(getenv("POWERPC_RAS")) : 0);
+    powerpc_enable_hooks(core, HOOK_BRANCH, "POWERPC_PREDICTOR");
+  }
+
+  /* Energy model, coefficients from a file */
+  if(getenv("POWERPC_ENERGY") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    if(core.caches == NULL)
+      core.caches=new powerpc_caches();
+    core.energy=new powerpc_energy();
+    if(!core.energy->load(getenv("POWERPC_ENERGY"))) {
+      fprintf(stderr, "powerpc: cannot read energy coefficients %s\n", getenv("POWERPC_ENERGY"));
+      exit(-1);
+    }
+    if(getenv("POWERPC_ENERGY_SERIES") != NULL) {
+      char path[256];
+      snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_ENERGY_SERIES"), core.index);
+      if((core.energy->series=fopen(path, "w")) == NULL) {
+        fprintf(stderr, "powerpc: cannot write %s\n", path);
+        exit(-1);
+      }
+      fprintf(core.energy->series, "# instructions cycles pJ\n");
+      core.energy->interval=getenv("POWERPC_ENERGY_INTERVAL") ? strtoull(getenv("POWERPC_ENERGY_INTERVAL"), NULL, 0) : 1000000;
+      if(core.energy->interval == 0)
+        core.energy->interval=1000000;
+      core.events.schedule(EVENT_ENERGY, core.energy->interval);
+    }
+    powerpc_enable_hooks(core, HOOK_ISSUE | HOOK_DATA, "POWERPC_ENERGY");
+  }
+
+  /* Instruction mix counters */
+  if(getenv("POWERPC_MIX") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    core.mix=new powerpc_mix();
+    powerpc_enable_hooks(core, HOOK_ISSUE, "POWERPC_MIX");
+  }
+
+  /* Instrumentation plug-ins, loaded once and shared by the cores */
+  if(getenv("POWERPC_PLUGINS") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    if(processors_started == 0 && !powerpc_plugins().load(getenv("POWERPC_PLUGINS")))
+      exit(-1);
+    core.plugins=&powerpc_plugins();
+    powerpc_enable_hooks(core, core.plugins->hooks(), "POWERPC_PLUGINS");
+    core.plugins->begin(core.index);
+  }
+
+  /* Binary instruction and memory trace */
+  if(getenv("POWERPC_TRACE") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    unsigned long long mb=getenv("POWERPC_TRACE_LIMIT") ? strtoull(getenv("POWERPC_TRACE_LIMIT"), NULL, 0) : 0;
+    char path[256];
+    snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_TRACE"), core.index);
+    core.trace=new powerpc_trace_writer();
+    if(!core.trace->open(path, mb << 20)) {
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+      exit(-1);
+    }
+    powerpc_enable_hooks(core, HOOK_ISSUE | HOOK_DATA, "POWERPC_TRACE");
+  }
+
+  /* Basic-block vectors for SimPoint */
+  if(getenv("POWERPC_BBV") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    unsigned long long n=getenv("POWERPC_BBV_INTERVAL") ? strtoull(getenv("POWERPC_BBV_INTERVAL"), NULL, 0) : 100000000;
+    char path[256];
+    FILE *out;
+    snprintf(path, sizeof(path), "%s.%u.bb", getenv("POWERPC_BBV"), core.index);
+    if((out=fopen(path, "w")) == NULL) {
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+      exit(-1);
+    }
+    core.bbv=new powerpc_bbv(out, n ? n : 100000000);
+    powerpc_enable_hooks(core, HOOK_BRANCH, "POWERPC_BBV");
+  }
+
+  /* Call-graph profiler */
+  if(getenv("POWERPC_CALLGRAPH") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    std::string elf=getenv("POWERPC_PROFILE_ELF") ? getenv("POWERPC_PROFILE_ELF") : powerpc_load_path();
+    core.callgraph=new powerpc_callgraph();
+    if(elf.empty() || core.callgraph->symbols.load(elf.c_str()) < 0)
+      fprintf(stderr, "powerpc: no symbols from '%s', call graph shows addresses\n", elf.c_str());
+    powerpc_enable_hooks(core, HOOK_BRANCH, "POWERPC_CALLGRAPH");
+  }
+
+  /* Data watchpoints */
+  if(getenv("POWERPC_WATCH") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    core.watch=new powerpc_watch();
+    if(!core.watch->load(getenv("POWERPC_WATCH"))) {
+      fprintf(stderr, "powerpc: bad watchpoint list %s\n", getenv("POWERPC_WATCH"));
+      exit(-1);
+    }
+    core.watch->stop=getenv("POWERPC_WATCH_STOP") != NULL;
+    powerpc_enable_hooks(core, HOOK_DATA, "POWERPC_WATCH");
+  }
+
+  /* Checkpoints for reverse debugging */
+  if(getenv("POWERPC_SNAPSHOT") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    unsigned long long n=strtoull(getenv("POWERPC_SNAPSHOT"), NULL, 0);
+    core.history=new powerpc_history(n ? n : 10000000,
+                                     getenv("POWERPC_SNAPSHOT_KEEP") ? atoi(getenv("POWERPC_SNAPSHOT_KEEP")) : 32,
+                                     AC_RAM_END);
+    core.events.schedule(EVENT_SNAPSHOT, core.instret);
+    powerpc_enable_hooks(core, HOOK_STORE, "POWERPC_SNAPSHOT");
+  }
+
+  /* Reuse distance and working set of the data accesses */
+  if(getenv("POWERPC_REUSE") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    unsigned int rate=getenv("POWERPC_REUSE_RATE") ? atoi(getenv("POWERPC_REUSE_RATE")) : 100;
+    unsigned long long n=getenv("POWERPC_REUSE_INTERVAL") ? strtoull(getenv("POWERPC_REUSE_INTERVAL"), NULL, 0) : 1000000;
+    std::string elf=getenv("POWERPC_PROFILE_ELF") ? getenv("POWERPC_PROFILE_ELF") : powerpc_load_path();
+    char path[256];
+    core.reuse=new powerpc_reuse(32, rate, n ? n : 1000000, core.stack.limit, core.stack.top);
+    if(elf.empty() || core.reuse->functions.load(elf.c_str()) < 0 || core.reuse->objects.load(elf.c_str(), 1) < 0)
+      fprintf(stderr, "powerpc: no symbols from '%s', reuse profile shows addresses\n", elf.c_str());
+    snprintf(path, sizeof(path), "%s.%u.ws", getenv("POWERPC_REUSE"), core.index);
+    if((core.reuse->series=fopen(path, "w")) == NULL) {
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+      exit(-1);
+    }
+    fprintf(core.reuse->series, "# instructions working-set-bytes\n");
+    powerpc_enable_hooks(core, HOOK_ISSUE | HOOK_DATA, "POWERPC_REUSE");
+  }
+
+  /* Sampling profiler, symbolized with the loaded ELF */
+  if(getenv("POWERPC_PROFILE") != NULL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    unsigned long long n=getenv("POWERPC_PROFILE_INTERVAL") ? strtoull(getenv("POWERPC_PROFILE_INTERVAL"), NULL, 0) : 10007;
+    std::string elf=getenv("POWERPC_PROFILE_ELF") ? getenv("POWERPC_PROFILE_ELF") : powerpc_load_path();
+    core.profiler=new powerpc_profiler(n ? n : 10007, 64);
+    if(elf.empty() || core.profiler->symbols.load(elf.c_str()) < 0)
+      fprintf(stderr, "powerpc: no symbols from '%s', profile shows addresses\n", elf.c_str());
+    core.events.schedule(EVENT_PROFILE, core.profiler->interval);
+  }
+
   /* Here the stack is started in a */
   // GPR.write(1,AC_RAM_END - 1024);
-  GPR.write(1, AC_RAM_END - 1024 - processors_started++ * DEFAULT_STACK_SIZE);
+  GPR.write(1, powerpc_core_of(&ac_pc).stack.top - 1024);
+  processors_started++;
   /* Make a jump out of DC_portory if it doesn't have an abi */
   LR.write(0xFFFFFFFF);
   
@@ -466,58 +947,156 @@ void ac_behavior( begin )
 void ac_behavior(end)
 {
   dbg_printf("@@@ end behavior @@@\n");
+
+  powerpc_core &core=powerpc_core_of(&ac_pc);
+
+  if(getenv("POWERPC_STACK_SIZE") != NULL || core.stack.overflowed)
+    fprintf(stderr, "powerpc: core %u stack: %u of %u bytes used at most\n",
+            core.index, core.stack.peak(), core.stack.size());
+  if(core.timing)
+    fprintf(stderr, "powerpc: core %u timing table: %llu cycles\n", core.index, core.cycles);
+  if(core.pipeline)
+    core.pipeline->report(stderr, core.index);
+  if(core.caches)
+    core.caches->report(stderr, core.index);
+  if(core.predictor)
+    core.predictor->report(stderr, core.index, 20);
+  if(core.plugins)
+    core.plugins->end(core.index, core.instret);
+  if(core.mix) {
+    char path[256];
+    FILE *out;
+    snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_MIX"), core.index);
+    if((out=fopen(path, "w")) == NULL)
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+    else {
+      core.mix->report(out);
+      fclose(out);
+    }
+  }
+  if(core.trace) {
+    core.trace->close();
+    fprintf(stderr, "powerpc: core %u trace: %llu fetches, %llu data accesses, %llu bytes%s\n",
+            core.index, core.trace->fetches, core.trace->accesses, core.trace->written,
+            core.trace->stopped ? " (limit reached)" : "");
+  }
+  if(core.bbv) {
+    char path[256];
+    FILE *out;
+    core.bbv->finish(core.instret);
+    core.bbv->close();
+    snprintf(path, sizeof(path), "%s.%u.map", getenv("POWERPC_BBV"), core.index);
+    if((out=fopen(path, "w")) == NULL)
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+    else {
+      core.bbv->write_map(out);
+      fclose(out);
+    }
+    fprintf(stderr, "powerpc: core %u: %llu basic-block vectors of %llu instructions\n",
+            core.index, core.bbv->intervals, core.bbv->interval);
+  }
+  if(core.callgraph) {
+    char path[256];
+    FILE *out;
+    core.callgraph->finish(core.instret, core_cycles(core));
+    snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_CALLGRAPH"), core.index);
+    if((out=fopen(path, "w")) == NULL)
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+    else {
+      core.callgraph->write(out);
+      fclose(out);
+    }
+    fprintf(stderr, "powerpc: core %u call graph: %llu calls, %llu returns, %llu tail calls, %llu unmatched returns\n",
+            core.index, core.callgraph->calls, core.callgraph->returns,
+            core.callgraph->tail_calls, core.callgraph->unmatched);
+  }
+  if(core.reuse) {
+    char path[256];
+    FILE *out;
+    core.reuse->finish(core.instret);
+    fclose(core.reuse->series);
+    core.reuse->series=NULL;
+    snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_REUSE"), core.index);
+    if((out=fopen(path, "w")) == NULL)
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+    else {
+      core.reuse->write(out);
+      fclose(out);
+    }
+  }
+  if(core.profiler) {
+    char path[256];
+    FILE *out;
+    snprintf(path, sizeof(path), "%s.%u", getenv("POWERPC_PROFILE"), core.index);
+    if((out=fopen(path, "w")) == NULL)
+      fprintf(stderr, "powerpc: cannot write %s\n", path);
+    else {
+      core.profiler->write_collapsed(out);
+      fclose(out);
+    }
+    core.profiler->report(stderr, core.index, 10);
+  }
+  if(core.energy) {
+    core.energy->sample(core.instret, core_cycles(core));
+    core.energy->report(stderr, core.index, core_cycles(core));
+    if(core.energy->series) {
+      fclose(core.energy->series);
+      core.energy->series=NULL;
+    }
+  }
 }
 
 //! Instruction Format behavior methods.
-void ac_behavior( I1 ){}
-void ac_behavior( B1 ){}
-void ac_behavior( SC1 ){}
-void ac_behavior( D1 ){}
-void ac_behavior( D2 ){}
-void ac_behavior( D3 ){}
-void ac_behavior( D4 ){}
-void ac_behavior( D5 ){}
-void ac_behavior( D6 ){}
-void ac_behavior( D7 ){}
-void ac_behavior( X1 ){}
-void ac_behavior( X2 ){}
-void ac_behavior( X3 ){}
-void ac_behavior( X4 ){}
-void ac_behavior( X5 ){}
-void ac_behavior( X6 ){}
-void ac_behavior( X7 ){}
-void ac_behavior( X8 ){}
-void ac_behavior( X9 ){}
-void ac_behavior( X10 ){}
-void ac_behavior( X11 ){}
-void ac_behavior( X12 ){}
-void ac_behavior( X13 ){}
-void ac_behavior( X14 ){}
-void ac_behavior( X15 ){}
-void ac_behavior( X16 ){}
-void ac_behavior( X17 ){}
-void ac_behavior( X18 ){}
-void ac_behavior( X19 ){}
-void ac_behavior( X20 ){}
-void ac_behavior( X21 ){}
-void ac_behavior( X22 ){}
-void ac_behavior( X23 ){}
-void ac_behavior( X24 ){}
-void ac_behavior( X25 ){}
-void ac_behavior( XL1 ){}
-void ac_behavior( XL2 ){}
-void ac_behavior( XL3 ){}
-void ac_behavior( XL4 ){}
-void ac_behavior( XFX1 ){}
-void ac_behavior( XFX2 ){}
-void ac_behavior( XFX3 ){}
-void ac_behavior( XFX4 ){}
-void ac_behavior( XFX5 ){}
-void ac_behavior( XO1 ){}
-void ac_behavior( XO2 ){}
-void ac_behavior( XO3 ){}
-void ac_behavior( M1 ){}
-void ac_behavior( M2 ){}
+//! They pass the operands of the instruction to the issue hook.
+void ac_behavior( I1 ){ insn_issue(0, (aa<<1)|lk, lk ? REG_LR : REG_NONE, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( B1 ){ insn_issue(0, (aa<<1)|lk, lk ? REG_LR : REG_NONE, (bo & 0x04) ? REG_NONE : REG_CTR, REG_CR, (bo & 0x04) ? REG_NONE : REG_CTR, REG_NONE, 0); }
+void ac_behavior( SC1 ){ insn_issue(0, 0, REG_NONE, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( D1 ){ insn_issue(0, 0, rt, (opcd == 13) ? REG_CR : REG_NONE, ra, REG_NONE, REG_NONE, (opcd == 46) ? 32-rt : 0); }
+void ac_behavior( D2 ){ insn_issue(0, 0, ra, REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( D3 ){ insn_issue(0, 0, REG_NONE, REG_NONE, rs, ra, REG_NONE, (opcd == 47) ? 32-rs : 0); }
+void ac_behavior( D4 ){ insn_issue(0, 0, ra, (opcd == 28 || opcd == 29) ? REG_CR : REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( D5 ){ insn_issue(0, 0, REG_CR, REG_NONE, ra, REG_NONE, REG_NONE, 0); }
+void ac_behavior( D6 ){ insn_issue(0, 0, REG_CR, REG_NONE, ra, REG_NONE, REG_NONE, 0); }
+void ac_behavior( D7 ){ insn_issue(0, 0, REG_NONE, REG_NONE, ra, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X1 ){ insn_issue(xog, rc, rt, rc ? REG_CR : REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( X2 ){ insn_issue(xog, 0, rt, REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( X3 ){ insn_issue(xog, 0, rt, REG_NONE, ra, REG_NONE, REG_NONE, nb ? (nb+3)/4 : 8); }
+void ac_behavior( X4 ){ insn_issue(xog, 0, rt, REG_NONE, ra, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X5 ){ insn_issue(xog, 0, rt, REG_NONE, rb, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X6 ){ insn_issue(xog, 0, rt, REG_NONE, (xog == 19) ? REG_CR : REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X7 ){ insn_issue(xog, rc, ra, rc ? REG_CR : REG_NONE, rs, rb, REG_NONE, 0); }
+void ac_behavior( X8 ){ insn_issue(xog, 0, ra, REG_CR, rs, rb, REG_NONE, 0); }
+void ac_behavior( X9 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, ra, rb, 0); }
+void ac_behavior( X10 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, ra, REG_NONE, nb ? (nb+3)/4 : 8); }
+void ac_behavior( X11 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, ra, REG_NONE, 0); }
+void ac_behavior( X12 ){ insn_issue(xog, rc, ra, rc ? REG_CR : REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X13 ){ insn_issue(xog, rc, ra, rc ? REG_CR : REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X14 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, rb, REG_NONE, 0); }
+void ac_behavior( X15 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X16 ){ insn_issue(xog, 0, REG_CR, REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( X17 ){ insn_issue(xog, rc, REG_CR, REG_NONE, REG_CR, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X18 ){ insn_issue(xog, 0, REG_CR, REG_XER, REG_XER, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X19 ){ insn_issue(xog, rc, REG_CR, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X20 ){ insn_issue(xog, 0, REG_CR, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X21 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( X22 ){ insn_issue(xog, rc, REG_CR, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X23 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( X24 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( X25 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XL1 ){ insn_issue(xog, 0, REG_CR, REG_NONE, REG_CR, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XL2 ){ insn_issue(xog, lk, lk ? REG_LR : REG_NONE, (bo & 0x04) ? REG_NONE : REG_CTR, (xog == 16) ? REG_LR : REG_CTR, REG_CR, REG_NONE, 0); }
+void ac_behavior( XL3 ){ insn_issue(xog, 0, REG_CR, REG_NONE, REG_CR, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XL4 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XFX1 ){ insn_issue(xog, 0, rt, REG_NONE, spr_operand(sprf), REG_NONE, REG_NONE, 0); }
+void ac_behavior( XFX2 ){ insn_issue(xog, 0, rt, REG_NONE, REG_NONE, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XFX3 ){ insn_issue(xog, 0, REG_CR, REG_NONE, rs, REG_CR, REG_NONE, 0); }
+void ac_behavior( XFX4 ){ insn_issue(xog, 0, spr_operand(sprf), REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XFX5 ){ insn_issue(xog, 0, REG_NONE, REG_NONE, rs, REG_NONE, REG_NONE, 0); }
+void ac_behavior( XO1 ){ insn_issue((oe<<9)|xos, rc, rt, rc ? REG_CR : REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( XO2 ){ insn_issue(xos, rc, rt, rc ? REG_CR : REG_NONE, ra, rb, REG_NONE, 0); }
+void ac_behavior( XO3 ){ insn_issue((oe<<9)|xos, rc, rt, rc ? REG_CR : REG_NONE, ra, REG_NONE, REG_NONE, 0); }
+void ac_behavior( M1 ){ insn_issue(0, rc, ra, rc ? REG_CR : REG_NONE, rs, rb, REG_NONE, 0); }
+void ac_behavior( M2 ){ insn_issue(0, rc, ra, rc ? REG_CR : REG_NONE, rs, (opcd == 20) ? ra : REG_NONE, REG_NONE, 0); }
 
 
 //!Instruction add behavior method.
@@ -901,7 +1480,9 @@ void ac_behavior( andis_ )
 void ac_behavior( b )
 {
   dbg_printf(" b %d\n\n",li);
-  do_Branch(ac_pc, LR, li,aa,lk);
+  powerpc_branch br;
+  do_Branch(ac_pc, LR, li,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -909,7 +1490,9 @@ void ac_behavior( b )
 void ac_behavior( ba )
 {
   dbg_printf(" ba %d\n\n",li);
-  do_Branch(ac_pc, LR, li,aa,lk);
+  powerpc_branch br;
+  do_Branch(ac_pc, LR, li,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -917,7 +1500,9 @@ void ac_behavior( ba )
 void ac_behavior( bl )
 {
   dbg_printf(" bl %d\n\n",li);
-  do_Branch(ac_pc, LR, li,aa,lk);
+  powerpc_branch br;
+  do_Branch(ac_pc, LR, li,aa,lk, br);
+  end_block(br);
   
 };
 
@@ -925,7 +1510,9 @@ void ac_behavior( bl )
 void ac_behavior( bla )
 {
   dbg_printf(" bla %d\n\n",li);
-  do_Branch(ac_pc, LR, li,aa,lk);
+  powerpc_branch br;
+  do_Branch(ac_pc, LR, li,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -933,7 +1520,9 @@ void ac_behavior( bla )
 void ac_behavior( bc )
 {
   dbg_printf(" bc %d, %d, %d\n\n",bo,bi,bd);
-  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk);
+  powerpc_branch br;
+  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -941,7 +1530,9 @@ void ac_behavior( bc )
 void ac_behavior( bca )
 {
   dbg_printf(" bca %d, %d, %d\n\n",bo,bi,bd);
-  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk);
+  powerpc_branch br;
+  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -949,7 +1540,9 @@ void ac_behavior( bca )
 void ac_behavior( bcl )
 {
   dbg_printf(" bcl %d, %d, %d\n\n",bo,bi,bd);
-  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk);
+  powerpc_branch br;
+  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk, br);
+  end_block(br);
   
 };
 
@@ -957,7 +1550,9 @@ void ac_behavior( bcl )
 void ac_behavior( bcla )
 {
   dbg_printf(" bcla %d, %d, %d\n\n",bo,bi,bd);
-  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk);
+  powerpc_branch br;
+  do_Branch_Cond(ac_pc, LR, CR, CTR, bo,bi,bd,aa,lk, br);
+  end_block(br);
 
 };
 
@@ -965,7 +1560,9 @@ void ac_behavior( bcla )
 void ac_behavior( bcctr )
 {
   dbg_printf(" bcctr %d, %d\n\n",bo,bi);
-  do_Branch_Cond_Count_Reg(ac_pc, LR, CR, CTR,bo,bi,lk);
+  powerpc_branch br;
+  do_Branch_Cond_Count_Reg(ac_pc, LR, CR, CTR,bo,bi,lk, br);
+  end_block(br);
 
 };
 
@@ -973,7 +1570,9 @@ void ac_behavior( bcctr )
 void ac_behavior( bcctrl )
 {
   dbg_printf(" bcctrl %d, %d\n\n",bo,bi);
-  do_Branch_Cond_Count_Reg(ac_pc, LR, CR, CTR,bo,bi,lk);
+  powerpc_branch br;
+  do_Branch_Cond_Count_Reg(ac_pc, LR, CR, CTR,bo,bi,lk, br);
+  end_block(br);
 
 };
 
@@ -981,7 +1580,9 @@ void ac_behavior( bcctrl )
 void ac_behavior( bclr )
 {
   dbg_printf(" bclr %d, %d\n\n",bo,bi);
-  do_Branch_Cond_Link_Reg(ac_pc, LR, CR, CTR,bo,bi,lk);
+  powerpc_branch br;
+  do_Branch_Cond_Link_Reg(ac_pc, LR, CR, CTR,bo,bi,lk, br);
+  end_block(br);
 
 };
 
@@ -989,7 +1590,9 @@ void ac_behavior( bclr )
 void ac_behavior( bclrl )
 {
   dbg_printf(" bclrl %d, %d\n\n",bo,bi);
-  do_Branch_Cond_Link_Reg(ac_pc, LR, CR, CTR,bo,bi,lk);
+  powerpc_branch br;
+  do_Branch_Cond_Link_Reg(ac_pc, LR, CR, CTR,bo,bi,lk, br);
+  end_block(br);
 
 };
 
@@ -1345,6 +1948,13 @@ void ac_behavior( crxor )
 
 };
 
+//!Instruction dcbst behavior method.
+/* There is no data cache to write back */
+void ac_behavior( dcbst )
+{
+  dbg_printf(" dcbst r%d, r%d\n\n",ra,rb);
+};
+
 //!Instruction divw behavior method.
 void ac_behavior( divw )
 {
@@ -1495,6 +2105,25 @@ void ac_behavior( extsh_ )
 };
 
 
+//!Instruction icbi behavior method.
+/* Only the cache tags of the pipeline and energy models hold instructions */
+void ac_behavior( icbi )
+{
+  dbg_printf(" icbi r%d, r%d\n\n",ra,rb);
+
+  powerpc_core &core = powerpc_core_of(&ac_pc);
+
+  if(core.caches)
+    core.caches->icache.invalidate((ra ? GPR.read(ra) : 0) + GPR.read(rb));
+};
+
+//!Instruction isync behavior method.
+/* Instructions are fetched from memory on every execution */
+void ac_behavior( isync )
+{
+  dbg_printf(" isync\n\n");
+};
+
 //!Instruction lbz behavior method.
 void ac_behavior( lbz )
 {
@@ -1507,7 +2136,7 @@ void ac_behavior( lbz )
   else
     ea=(short int)d;
  
-  GPR.write(rt,(unsigned int)DATA_PORT->read_byte(ea));
+  GPR.write(rt,(unsigned int)DATA_READ_BYTE(ea));
   
 };
 
@@ -1521,7 +2150,7 @@ void ac_behavior( lbzu )
   ea=GPR.read(ra)+(short int)d;
   
   GPR.write(ra,ea);
-  GPR.write(rt,(unsigned int)DATA_PORT->read_byte(ea));
+  GPR.write(rt,(unsigned int)DATA_READ_BYTE(ea));
   
 };
 
@@ -1535,7 +2164,7 @@ void ac_behavior( lbzux )
   ea=GPR.read(ra)+GPR.read(rb);
   
   GPR.write(ra,ea);
-  GPR.write(rt,(unsigned int)DATA_PORT->read_byte(ea));
+  GPR.write(rt,(unsigned int)DATA_READ_BYTE(ea));
   
 };
 
@@ -1551,7 +2180,7 @@ void ac_behavior( lbzx )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,(unsigned int)DATA_PORT->read_byte(ea));
+  GPR.write(rt,(unsigned int)DATA_READ_BYTE(ea));
   
 };
 
@@ -1567,7 +2196,7 @@ void ac_behavior( lha )
   else
     ea=(short int)d;
  
-  GPR.write(rt,(short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(short int)DATA_READ_HALF(ea));
   
 };
 
@@ -1579,7 +2208,7 @@ void ac_behavior( lhau )
   int ea=GPR.read(ra)+(short int)d;
 
   GPR.write(ra,ea);
-  GPR.write(rt,(short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(short int)DATA_READ_HALF(ea));
   
 };
 
@@ -1591,7 +2220,7 @@ void ac_behavior( lhaux )
   int ea=GPR.read(ra)+GPR.read(rb);
 
   GPR.write(ra,ea);
-  GPR.write(rt,(short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(short int)DATA_READ_HALF(ea));
   
 };
 
@@ -1607,7 +2236,7 @@ void ac_behavior( lhax )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,(short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(short int)DATA_READ_HALF(ea));
   
 };
 
@@ -1623,7 +2252,7 @@ void ac_behavior( lhbrx )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,(((int)(DATA_PORT->read_byte(ea+1)) & 0x000000FF)<<8) | ((int)(DATA_PORT->read_byte(ea)) & 0x000000FF));
+  GPR.write(rt,(((int)(DATA_READ_BYTE(ea+1)) & 0x000000FF)<<8) | ((int)(DATA_READ_BYTE(ea)) & 0x000000FF));
 
 };
 
@@ -1639,7 +2268,7 @@ void ac_behavior( lhz )
   else
     ea=(short int)d;
 
-  GPR.write(rt,(unsigned short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(unsigned short int)DATA_READ_HALF(ea));
 
 };
 
@@ -1651,7 +2280,7 @@ void ac_behavior( lhzu )
   int ea=GPR.read(ra)+(short int)d;
   
   GPR.write(ra,ea);
-  GPR.write(rt,(unsigned short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(unsigned short int)DATA_READ_HALF(ea));
 
 };
 
@@ -1663,7 +2292,7 @@ void ac_behavior( lhzux )
   int ea=GPR.read(ra)+GPR.read(rb);
 
   GPR.write(ra,ea);
-  GPR.write(rt,(unsigned short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(unsigned short int)DATA_READ_HALF(ea));
 
 };
 
@@ -1679,7 +2308,7 @@ void ac_behavior( lhzx )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,(unsigned short int)DATA_PORT->read_half(ea));
+  GPR.write(rt,(unsigned short int)DATA_READ_HALF(ea));
   
 };
 
@@ -1700,7 +2329,7 @@ void ac_behavior( lmw )
 
   while(r<=31) {
     if((r!=ra)||(r==31))
-      GPR.write(r,DATA_PORT->read(ea));
+      GPR.write(r,DATA_READ(ea));
     r=r+1;
     ea=ea+4;
   }
@@ -1744,7 +2373,7 @@ void ac_behavior( lswi )
       masc=0xFF000000>>i;
       masc=~masc;
       GPR.write(r,(GPR.read(r) & masc));
-      GPR.write(r,(((unsigned int)DATA_PORT->read_byte(ea)) << (24-i)) | GPR.read(r));
+      GPR.write(r,(((unsigned int)DATA_READ_BYTE(ea)) << (24-i)) | GPR.read(r));
     }
     i=i+8;
     if(i==32)
@@ -1788,7 +2417,7 @@ void ac_behavior( lswx )
       masc=0xFF000000>>i;
       masc=~masc;
       GPR.write(r,(GPR.read(r) & masc));
-      GPR.write(r,(((unsigned int)DATA_PORT->read_byte(ea)) << (24-i)) | GPR.read(r));
+      GPR.write(r,(((unsigned int)DATA_READ_BYTE(ea)) << (24-i)) | GPR.read(r));
     }
     i=i+8;
     if(i==32)
@@ -1812,10 +2441,10 @@ void ac_behavior( lwbrx )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,(((unsigned int)DATA_PORT->read_byte(ea+3) & 0x000000FF) << 24) | 
-	    (((unsigned int)DATA_PORT->read_byte(ea+2) & 0x000000FF) << 16) | 
-	    (((unsigned int)DATA_PORT->read_byte(ea+1) & 0x000000FF) << 8) | 
-	    ((unsigned int)DATA_PORT->read_byte(ea) & 0x000000FF));
+  GPR.write(rt,(((unsigned int)DATA_READ_BYTE(ea+3) & 0x000000FF) << 24) | 
+	    (((unsigned int)DATA_READ_BYTE(ea+2) & 0x000000FF) << 16) | 
+	    (((unsigned int)DATA_READ_BYTE(ea+1) & 0x000000FF) << 8) | 
+	    ((unsigned int)DATA_READ_BYTE(ea) & 0x000000FF));
 
 };
 
@@ -1831,7 +2460,7 @@ void ac_behavior( lwz )
   else
     ea=(short int)d;
 
-  GPR.write(rt,DATA_PORT->read(ea));
+  GPR.write(rt,DATA_READ(ea));
 
 };
 
@@ -1843,7 +2472,7 @@ void ac_behavior( lwzu )
   int ea=GPR.read(ra)+(short int)d;
  
   GPR.write(ra,ea);
-  GPR.write(rt,DATA_PORT->read(ea));
+  GPR.write(rt,DATA_READ(ea));
 
 };
 
@@ -1855,7 +2484,7 @@ void ac_behavior( lwzux )
   int ea=GPR.read(ra)+GPR.read(rb);
 
   GPR.write(ra,ea);
-  GPR.write(rt,DATA_PORT->read(ea));
+  GPR.write(rt,DATA_READ(ea));
 
 };
 
@@ -1871,7 +2500,7 @@ void ac_behavior( lwzx )
   else
     ea=GPR.read(rb);
 
-  GPR.write(rt,DATA_PORT->read(ea));
+  GPR.write(rt,DATA_READ(ea));
   
 };
 
@@ -1947,11 +2576,20 @@ void ac_behavior( mfcr )
   
 };
 
+//!Instruction mfmsr behavior method.
+void ac_behavior( mfmsr )
+{
+  dbg_printf(" mfmsr r%d\n\n",rt);
+  GPR.write(rt,MSR.read());
+
+};
+
 //!Instruction mfspr behavior method.
 void ac_behavior( mfspr )
 {
   /* This instruction is a fix, other implementations can be better */
   dbg_printf(" mfspr r%d,%d\n\n",rt,sprf);
+  powerpc_core &core=powerpc_core_of(&ac_pc);
   unsigned int spvalue=sprf;
   spvalue=((spvalue>>5) & 0x0000001f ) |
     ((spvalue<<5) & 0x000003e0 );
@@ -1994,7 +2632,45 @@ void ac_behavior( mfspr )
       GPR.write(rt,SPRG7.read());
     break;
 
+    /* SRR0 */
+    case 0x01A:
+      GPR.write(rt,SRR0.read());
+    break;
+
+    /* SRR1 */
+    case 0x01B:
+      GPR.write(rt,SRR1.read());
+    break;
+
+    /* TBL */
+    case 0x10C:
+      GPR.write(rt,(unsigned int)core.timer.tb(core.instret));
+    break;
+
+    /* TBU */
+    case 0x10D:
+      GPR.write(rt,(unsigned int)(core.timer.tb(core.instret) >> 32));
+    break;
+
+    /* EVPR */
+    case 0x3D6:
+      GPR.write(rt,EVPR.read());
+    break;
+
+    /* TSR */
+    case 0x3D8:
+      GPR.write(rt,TSR.read());
+    break;
+
+    /* TCR */
+    case 0x3DA:
+      GPR.write(rt,TCR.read());
+    break;
 
+    /* PIT */
+    case 0x3DB:
+      GPR.write(rt,core.timer.pit_read(core.events, core.instret));
+    break;
 
     /* Not implemented yet! */
    default:
@@ -2007,6 +2683,37 @@ void ac_behavior( mfspr )
 };
 
 
+//!Instruction mftb behavior method.
+void ac_behavior( mftb )
+{
+  dbg_printf(" mftb r%d,%d\n\n",rt,sprf);
+  powerpc_core &core=powerpc_core_of(&ac_pc);
+  unsigned int tbrvalue=sprf;
+  tbrvalue=((tbrvalue>>5) & 0x0000001f ) |
+    ((tbrvalue<<5) & 0x000003e0 );
+
+  switch(tbrvalue) {
+
+    /* TBL */
+    case 0x10C:
+      GPR.write(rt,(unsigned int)core.timer.tb(core.instret));
+    break;
+
+    /* TBU */
+    case 0x10D:
+      GPR.write(rt,(unsigned int)(core.timer.tb(core.instret) >> 32));
+    break;
+
+    /* Invalid time base register */
+    default:
+      dbg_printf("\nERROR!\n");
+      exit(-1);
+    break;
+
+  }
+};
+
+
 //!Instruction mtcrf behavior method.
 void ac_behavior( mtcrf ) {
   dbg_printf(" mtcrf %d, r%d\n\n",xfm,rs);
@@ -2032,11 +2739,23 @@ void ac_behavior( mtcrf ) {
 
 
 
+//!Instruction mtmsr behavior method.
+void ac_behavior( mtmsr )
+{
+  dbg_printf(" mtmsr r%d\n\n",rs);
+  MSR.write(GPR.read(rs));
+
+  /* Enabling MSR.EE may unmask a pending timer interrupt */
+  test_interrupts();
+
+};
+
 //!Instruction mtspr behavior method.
 void ac_behavior( mtspr )
 {
   /* This instruction is a fix, other implementations can be better */
   dbg_printf(" mtspr %d,r%d\n\n",sprf,rs);
+  powerpc_core &core=powerpc_core_of(&ac_pc);
   unsigned int spvalue=sprf;
   spvalue=((spvalue>>5) & 0x0000001f ) |
     ((spvalue<<5) & 0x000003e0 );
@@ -2078,6 +2797,49 @@ void ac_behavior( mtspr )
       SPRG7.write(GPR.read(rs));
     break;
 
+    /* SRR0 */
+    case 0x01A:
+      SRR0.write(GPR.read(rs));
+    break;
+
+    /* SRR1 */
+    case 0x01B:
+      SRR1.write(GPR.read(rs));
+    break;
+
+    /* TBL */
+    case 0x11C:
+      core.timer.tbl_write(core.instret, GPR.read(rs));
+      core.timer.fit_schedule(core.events, TCR.read(), core.instret);
+    break;
+
+    /* TBU */
+    case 0x11D:
+      core.timer.tbu_write(core.instret, GPR.read(rs));
+      core.timer.fit_schedule(core.events, TCR.read(), core.instret);
+    break;
+
+    /* EVPR */
+    case 0x3D6:
+      EVPR.write(GPR.read(rs));
+    break;
+
+    /* TSR: write 1 to clear */
+    case 0x3D8:
+      TSR.write(TSR.read() & ~GPR.read(rs));
+    break;
+
+    /* TCR */
+    case 0x3DA:
+      TCR.write(GPR.read(rs));
+      core.timer.fit_schedule(core.events, TCR.read(), core.instret);
+      test_interrupts();
+    break;
+
+    /* PIT */
+    case 0x3DB:
+      core.timer.pit_write(core.events, core.instret, GPR.read(rs));
+    break;
 
     /* Not implemented yet! */
     default:
@@ -2452,6 +3214,20 @@ void ac_behavior( oris )
   GPR.write(ra,GPR.read(rs) | (((int)((unsigned short int)ui)) << 16));
 };
 
+//!Instruction rfi behavior method.
+void ac_behavior( rfi )
+{
+  dbg_printf(" rfi\n\n");
+
+  ac_pc=SRR0.read() & 0xFFFFFFFC;
+  MSR.write(SRR1.read());
+
+  end_redirect();
+  test_events();
+  test_interrupts();
+
+};
+
 //!Instruction rlwimi behavior method.
 void ac_behavior( rlwimi )
 {
@@ -2509,7 +3285,7 @@ void ac_behavior( rlwnm )
 {
   dbg_printf(" rlwnm r%d, r%d, %d, %d, %d\n\n",ra,rs,rb,mb,me);
   
-  unsigned int r=rotl(GPR.read(rs),(GPR.read(rb) | 0x0000001F));
+  unsigned int r=rotl(GPR.read(rs),(GPR.read(rb) & 0x0000001F));
   unsigned int m=mask32rlw(mb,me);
 
   GPR.write(ra,(r & m));
@@ -2521,7 +3297,7 @@ void ac_behavior( rlwnm_ )
 {
   dbg_printf(" rlwnm. r%d, r%d, %d, %d, %d\n\n",ra,rs,rb,mb,me);
   
-  unsigned int r=rotl(GPR.read(rs),(GPR.read(rb) | 0x0000001F));
+  unsigned int r=rotl(GPR.read(rs),(GPR.read(rb) & 0x0000001F));
   unsigned int m=mask32rlw(mb,me);
 
   GPR.write(ra,(r & m));
@@ -2543,8 +3319,16 @@ void ac_behavior( sc )
 
   SRR0.write((ac_pc-4)+4); /* Only to understand pre-increment */
 
+  if(POWERPC_HOOKS & HOOK_SYSCALL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    if(core.hooks & HOOK_SYSCALL)
+      powerpc_plugins().syscall(core.index, ac_pc-4, GPR.read(0), 0);
+  }
+
   ac_pc=((EVPR.read() & 0xFFFF0000) | 0x00000C00);
 
+  end_redirect();
+
 };
 
 //!Instruction slw behavior method.
@@ -2756,7 +3540,7 @@ void ac_behavior( stb )
   else
     ea=(short int)d;
  
-  DATA_PORT->write_byte(ea,(unsigned char)GPR.read(rs));
+  DATA_WRITE_BYTE(ea,(unsigned char)GPR.read(rs));
     
 };
 
@@ -2767,7 +3551,7 @@ void ac_behavior( stbu )
   
   int ea=GPR.read(ra)+(short int)d;
  
-  DATA_PORT->write_byte(ea,(unsigned char)GPR.read(rs));
+  DATA_WRITE_BYTE(ea,(unsigned char)GPR.read(rs));
   GPR.write(ra,ea);
     
 };
@@ -2779,7 +3563,7 @@ void ac_behavior( stbux )
   
   int ea=GPR.read(ra)+GPR.read(rb);
  
-  DATA_PORT->write_byte(ea,(unsigned char)GPR.read(rs));
+  DATA_WRITE_BYTE(ea,(unsigned char)GPR.read(rs));
   GPR.write(ra,ea);
     
 };
@@ -2796,7 +3580,7 @@ void ac_behavior( stbx )
   else
     ea=GPR.read(rb);
   
-  DATA_PORT->write_byte(ea,(unsigned char)GPR.read(rs));
+  DATA_WRITE_BYTE(ea,(unsigned char)GPR.read(rs));
    
 };
 
@@ -2812,7 +3596,7 @@ void ac_behavior( sth )
   else
     ea=(short int)d;
  
-  DATA_PORT->write_half(ea,(unsigned short int)GPR.read(rs));
+  DATA_WRITE_HALF(ea,(unsigned short int)GPR.read(rs));
     
 };
 
@@ -2828,7 +3612,7 @@ void ac_behavior( sthbrx )
   else
     ea=GPR.read(rb);
   
-  DATA_PORT->write_half(ea,(unsigned short int)
+  DATA_WRITE_HALF(ea,(unsigned short int)
 		 ( ((GPR.read(rs) & 0x000000FF) << 8) | 
 		   ((GPR.read(rs) & 0x0000FF00) >> 8) ));
    
@@ -2841,7 +3625,7 @@ void ac_behavior( sthu )
   
   int ea=GPR.read(ra)+(short int)d;
  
-  DATA_PORT->write_half(ea,(unsigned short int)GPR.read(rs));
+  DATA_WRITE_HALF(ea,(unsigned short int)GPR.read(rs));
   GPR.write(ra,ea);
     
 };
@@ -2853,7 +3637,7 @@ void ac_behavior( sthux )
   
   int ea=GPR.read(ra)+GPR.read(rb);
  
-  DATA_PORT->write_half(ea,(unsigned short int)GPR.read(rs));
+  DATA_WRITE_HALF(ea,(unsigned short int)GPR.read(rs));
   GPR.write(ra,ea);
     
 };
@@ -2870,7 +3654,7 @@ void ac_behavior( sthx )
   else
     ea=GPR.read(rb);
   
-  DATA_PORT->write_half(ea,(unsigned short int)GPR.read(rs));
+  DATA_WRITE_HALF(ea,(unsigned short int)GPR.read(rs));
     
 };
 
@@ -2890,7 +3674,7 @@ void ac_behavior( stmw )
   r=rs;
   
   while(r<=31) {
-    DATA_PORT->write(ea,GPR.read(r));
+    DATA_WRITE(ea,GPR.read(r));
     r+=1;
     ea+=4;
   }
@@ -2926,7 +3710,7 @@ void ac_behavior( stswi )
     if(r==32)
       r=0; 
     masc=mask32rlw(i,i+7);
-    DATA_PORT->write_byte(ea,(unsigned char)((GPR.read(r) & masc) >> (24-i)));
+    DATA_WRITE_BYTE(ea,(unsigned char)((GPR.read(r) & masc) >> (24-i)));
     i=i+8;
     if(i==32)
       i=0;
@@ -2962,7 +3746,7 @@ void ac_behavior( stswx )
     if(r==32)
       r=0; 
     masc=mask32rlw(i,i+7);
-    DATA_PORT->write_byte(ea,(unsigned char)((GPR.read(r) & masc) >> (24-i)));
+    DATA_WRITE_BYTE(ea,(unsigned char)((GPR.read(r) & masc) >> (24-i)));
     i=i+8;
     if(i==32)
       i=0;
@@ -2984,7 +3768,7 @@ void ac_behavior( stw )
   else
     ea=(short int)d;
 
-  DATA_PORT->write(ea,(unsigned int)GPR.read(rs));
+  DATA_WRITE(ea,(unsigned int)GPR.read(rs));
     
 };
 
@@ -3000,7 +3784,7 @@ void ac_behavior( stwbrx )
   else
     ea=GPR.read(rb);
 
-  DATA_PORT->write(ea,(((GPR.read(rs) & 0x000000FF) << 24)  |
+  DATA_WRITE(ea,(((GPR.read(rs) & 0x000000FF) << 24)  |
 		((GPR.read(rs) & 0x0000FF00) << 16 ) |
 		((GPR.read(rs) & 0x00FF0000) << 8 ) |
 		(GPR.read(rs) & 0xFF000000)));
@@ -3015,8 +3799,10 @@ void ac_behavior( stwu )
   
   int ea=GPR.read(ra)+(short int)d;
 
-  DATA_PORT->write(ea,(unsigned int)GPR.read(rs));
+  DATA_WRITE(ea,(unsigned int)GPR.read(rs));
   GPR.write(ra,ea);
+  if(ra == 1)
+    stack_push(ea);
     
 };
 
@@ -3027,8 +3813,10 @@ void ac_behavior( stwux )
   
   int ea=GPR.read(ra)+GPR.read(rb);
  
-  DATA_PORT->write(ea,GPR.read(rs));
+  DATA_WRITE(ea,GPR.read(rs));
   GPR.write(ra,ea);
+  if(ra == 1)
+    stack_push(ea);
     
 };
 
@@ -3044,7 +3832,7 @@ void ac_behavior( stwx )
   else
     ea=GPR.read(rb);
   
-  DATA_PORT->write(ea,(unsigned int)GPR.read(rs));
+  DATA_WRITE(ea,(unsigned int)GPR.read(rs));
    
 };
 
@@ -3321,6 +4109,12 @@ void ac_behavior( subfzeo_ )
   GPR.write(rt,result);
 };
 
+//!Instruction sync behavior method.
+void ac_behavior( sync )
+{
+  dbg_printf(" sync\n\n");
+};
+
 //!Instruction xor behavior method.
 void ac_behavior( xxor )
 {
@@ -33,6 +33,9 @@
  */
 
 #include "powerpc_syscall.H"
+#include "powerpc_plugin.H"
+#include "powerpc_session.H"
+#include "powerpc_args.H"
 
 using namespace powerpc_parms;
 
@@ -49,6 +52,10 @@ void powerpc_syscall::set_buffer(int argn, unsigned char* buf, unsigned int size
 {
   unsigned int addr = GPR.read(3+argn);
 
+  powerpc_core &core=powerpc_core_of(&ac_pc);
+  if(core.written)
+    core.written->mark(addr, size);
+
   for (unsigned int i = 0; i<size; i++, addr++) {
     DATA_PORT->write_byte(addr, buf[i]);
   }
@@ -58,6 +65,10 @@ void powerpc_syscall::set_buffer_noinvert(int argn, unsigned char* buf, unsigned
 {
   unsigned int addr = GPR.read(3+argn);
 
+  powerpc_core &core=powerpc_core_of(&ac_pc);
+  if(core.written)
+    core.written->mark(addr, size);
+
   for (unsigned int i = 0; i<size; i+=4, addr+=4) {
     DATA_PORT->write(addr, *(unsigned int *) &buf[i]);
   }
@@ -81,6 +92,13 @@ void powerpc_syscall::return_from_syscall()
 //  oldr31=MEM.read(GPR.read(1)+28);
 //  GPR.write(1,oldr1);
 //  GPR.write(31,oldr31);
+
+  if(POWERPC_HOOKS & HOOK_SYSCALL) {
+    powerpc_core &core=powerpc_core_of(&ac_pc);
+    if(core.hooks & HOOK_SYSCALL)
+      powerpc_plugins().syscall(core.index, ac_pc, ~0U, GPR.read(3));
+  }
+
   ac_pc=LR.read();
 }
 
@@ -88,8 +106,14 @@ void powerpc_syscall::set_prog_args(int argc, char **argv)
 {
   int i, j, base;
 
-  unsigned int ac_argv[30];
-  char ac_argstr[512];
+  unsigned int ac_argv[POWERPC_ARGS_MAX];
+  char ac_argstr[POWERPC_ARGS_BYTES];
+
+  if(!powerpc_args_fit(argc, powerpc_args_bytes(argc, argv))) {
+    fprintf(stderr, "powerpc: program arguments do not fit (at most %d arguments of %d bytes in all)\n",
+            POWERPC_ARGS_MAX, POWERPC_ARGS_BYTES);
+    exit(-1);
+  }
 
   base = AC_RAM_END - 512;
   for (i=0, j=0; i<argc; i++) {
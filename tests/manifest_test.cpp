@@ -0,0 +1,61 @@
+/**
+ * @file      manifest_test.cpp
+ *
+ * @brief     Tests of the job manifest reader of the batch runner.
+ *
+ * @attention Copyright (C) 2002-2026 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "powerpc_manifest.H"
+
+static int failures = 0;
+
+#define CHECK(c) { if (!(c)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #c); failures++; } }
+
+static bool read(const std::string &text, std::vector<powerpc_job> &jobs) {
+  FILE *f = fopen("manifest.txt", "w");
+  fputs(text.c_str(), f);
+  fclose(f);
+  jobs.clear();
+  return powerpc_read_manifest("manifest.txt", jobs);
+}
+
+int main() {
+
+  std::vector<powerpc_job> jobs;
+  std::string args;
+
+  /* Fields, redirections, comments and a last line without a newline */
+  CHECK(read("a.elf 1 2 <a.in >a.out\n# b.elf\n\n  c.elf", jobs));
+  CHECK(jobs.size() == 2);
+  CHECK(jobs[0].args.size() == 3 && jobs[0].args[2] == "2");
+  CHECK(jobs[0].in == "a.in" && jobs[0].out == "a.out");
+  CHECK(jobs[1].args.size() == 1 && jobs[1].args[0] == "c.elf" && jobs[1].in.empty());
+
+  /* A line longer than the buffer is rejected, not split into two jobs */
+  CHECK(!read("a.elf\nb.elf " + std::string(5000, 'x') + "\nc.elf\n", jobs));
+
+  /* argv as large as set_prog_args takes */
+  args = "p.elf";
+  for (unsigned int i = 1; i < POWERPC_ARGS_MAX; i++)
+    args += " a";
+  CHECK(read(args + "\n", jobs) && jobs.size() == 1 && jobs[0].args.size() == POWERPC_ARGS_MAX);
+  CHECK(read("p.elf " + std::string(POWERPC_ARGS_BYTES - 7, 'x') + "\n", jobs));
+
+  /* One argument more, or one byte more, would overflow it */
+  CHECK(!read(args + " a\n", jobs));
+  CHECK(!read("p.elf " + std::string(POWERPC_ARGS_BYTES - 6, 'x') + "\n", jobs));
+
+  remove("manifest.txt");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# @file      run.sh
+# @brief     Builds and runs the host tests of the model headers.
+#
+# Copyright (C) 2002-2026 --- The ArchC Team
+#
+# The tests cover headers that do not need ArchC or SystemC, so they
+# build with the host compiler alone:
+#
+#   tests/run.sh                (CXX selects the compiler, g++ by default)
+
+cd "$(dirname "$0")" || exit 1
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+failed=0
+
+for t in *_test.cpp; do
+  name=${t%.cpp}
+  if ! ${CXX:-g++} -std=c++98 -Wall -Wextra -I.. -o "$dir/$name" "$t"; then
+    echo "FAIL $name (build)"
+    failed=1
+  elif ! (cd "$dir" && "./$name"); then
+    echo "FAIL $name"
+    failed=1
+  else
+    echo "ok   $name"
+  fi
+done
+exit $failed
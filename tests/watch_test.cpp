@@ -0,0 +1,57 @@
+/**
+ * @file      watch_test.cpp
+ *
+ * @brief     Tests of the watchpoint list reader.
+ *
+ * @attention Copyright (C) 2002-2026 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <cstdio>
+
+#include "powerpc_watch.H"
+
+static int failures = 0;
+
+#define CHECK(c) { if (!(c)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #c); failures++; } }
+
+static bool load(const char *spec) {
+  powerpc_watch w;
+  return w.load(spec);
+}
+
+int main() {
+
+  /* Defaults and explicit modes */
+  CHECK(load("0x1000"));
+  CHECK(load("0x1000:4:w,0x2000:64"));
+  CHECK(load("0x1000:4:r,0x2000:4:rw,0x3000:4:wr"));
+
+  /* An empty or unknown mode would give a watchpoint that never fires */
+  CHECK(!load("0x1000:4:"));
+  CHECK(!load("0x1000:4:,0x2000"));
+  CHECK(!load("0x1000:4:x"));
+  CHECK(!load("0x1000:4:rx"));
+
+  /* Malformed addresses and lengths */
+  CHECK(!load(""));
+  CHECK(!load("x"));
+  CHECK(!load("0x1000:0"));
+  CHECK(!load("0x1000:"));
+
+  /* Modes select the accesses that hit */
+  powerpc_watch w;
+  CHECK(w.load("0x1000:4:w"));
+  CHECK(w.page(0x1000, 4) && !w.page(0x2000, 4));
+  CHECK(!w.check(0, 0, 0, 0x1000, 4, false, 0));
+  CHECK(w.hits == 0);
+  w.check(0, 0, 0, 0x1002, 2, true, 0);
+  CHECK(w.hits == 1);
+
+  return failures ? 1 : 0;
+}
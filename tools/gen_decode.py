@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+#
+# @file      gen_decode.py
+# @version   1.0
+# @date      Sun, 18 Oct 2026 22:41:37 -0300
+# @brief     Generates the two-level decode table of the POWERPC model.
+#
+# Copyright (C) 2002-2026 --- The ArchC Team
+#
+# Reads the ac_format, ac_instr and set_decoder() declarations of
+# powerpc_isa.ac and writes powerpc_decode.H. The first level is indexed
+# by the primary opcode; opcodes shared by several instructions get a
+# second level indexed by the low bits holding their extended opcode,
+# Rc, OE, AA and LK fields. Decoder fields outside those bits (L of the
+# compares) are checked by a final mask and match. Each entry also keeps
+# the set_cycles() annotation, the default of the timing tables.
+#
+#   tools/gen_decode.py            (rewrite powerpc_decode.H)
+#   tools/gen_decode.py --check    (verify the file against powerpc_isa.ac)
+
+import argparse
+import os
+import random
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+ISA = os.path.join(ROOT, "powerpc_isa.ac")
+OUT = os.path.join(ROOT, "powerpc_decode.H")
+
+HEADER = """/**
+ * @file      powerpc_decode.H
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br
+ *
+ * @version   1.0
+ * @date      Sun, 18 Oct 2026 22:41:37 -0300
+ *
+ * @brief     Two-level instruction decode table of the POWERPC model.
+ *
+ * @attention Copyright (C) 2002-2026 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+//Generated by tools/gen_decode.py from powerpc_isa.ac, do not edit.
+//Instructions are numbered from 1 in declaration order; 0 is invalid.
+"""
+
+
+def parse(path):
+    """Returns formats {name: {field: (lo, width)}}, the instructions in
+    declaration order [(name, format)], {name: {field: value}} and
+    {name: cycles}."""
+    text = re.sub(r"/\*.*?\*/", "", open(path).read(), flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+
+    formats = {}
+    for name, spec in re.findall(r"ac_format\s+(\w+)\s*=\s*\"([^\"]*)\"", text):
+        fields, bit = {}, 32
+        for f in spec.split():
+            m = re.match(r"%?(\w+):(\d+)", f)
+            width = int(m.group(2))
+            bit -= width
+            if f.startswith("%"):
+                fields[m.group(1)] = (bit, width)
+        if bit != 0:
+            sys.exit("gen_decode: format %s is not 32 bits" % name)
+        formats[name] = fields
+
+    instrs = []
+    for fmt, names in re.findall(r"ac_instr\s*<\s*(\w+)\s*>([^;]*);", text):
+        instrs += [(n.strip(), fmt) for n in names.split(",") if n.strip()]
+
+    decoders = {}
+    for name, args in re.findall(r"(\w+)\.set_decoder\s*\(([^)]*)\)", text):
+        decoders[name] = dict((k.strip(), int(v, 0)) for k, v in
+                              (a.split("=") for a in args.split(",")))
+    cycles = dict((name, int(n)) for name, n in re.findall(r"(\w+)\.set_cycles\s*\(\s*(\d+)\s*\)", text))
+    return formats, instrs, decoders, cycles
+
+
+def encode(formats, fmt, fields):
+    """Mask and match of the decoder fields."""
+    mask = match = 0
+    for f, v in fields.items():
+        if f not in formats[fmt]:
+            sys.exit("gen_decode: field %s not in format %s" % (f, fmt))
+        lo, width = formats[fmt][f]
+        m = ((1 << width) - 1) << lo
+        mask |= m
+        match |= (v << lo) & m
+    return mask, match
+
+
+def build(path):
+    formats, instrs, decoders, cycles = parse(path)
+    table = [("invalid", "-", 0, 0, 0)]
+    for name, fmt in instrs:
+        if name not in decoders:
+            sys.exit("gen_decode: %s has no set_decoder()" % name)
+        mask, match = encode(formats, fmt, decoders[name])
+        table.append((name, fmt, mask, match, cycles.get(name, 1)))
+
+    # Second level keys: the low 11 bits used by the decoders of an opcode
+    level1 = []
+    level2 = []
+    for opcd in range(64):
+        ids = [i for i, t in enumerate(table) if i and t[3] >> 26 == opcd]
+        used = 0
+        for i in ids:
+            used |= table[i][2] & 0x7FF
+        shift = 0
+        if used:
+            while not used >> shift & 1:
+                shift += 1
+        width = used.bit_length() - shift
+        base = len(level2)
+        slots = [0] * (1 << width)
+        for i in ids:
+            mask, match = table[i][2], table[i][3]
+            for k in range(1 << width):
+                w = (opcd << 26) | (k << shift)
+                if (w & mask & 0xFC0007FF) == (match & 0xFC0007FF):
+                    if slots[k] and table[slots[k]][2] & ~0xFC0007FF == 0:
+                        sys.exit("gen_decode: %s and %s share a decode slot" % (table[slots[k]][0], table[i][0]))
+                    if slots[k]:
+                        sys.exit("gen_decode: %s and %s need a third level" % (table[slots[k]][0], table[i][0]))
+                    slots[k] = i
+        level1.append((shift, (1 << width) - 1, base))
+        level2 += slots
+    return table, level1, level2, decoders
+
+
+def decode(table, level1, level2, w):
+    shift, mask, base = level1[w >> 26]
+    i = level2[base + ((w >> shift) & mask)]
+    return i if (w & table[i][2]) == table[i][3] else 0
+
+
+def write(table, level1, level2):
+    out = [HEADER, "#ifndef POWERPC_DECODE_H\n#define POWERPC_DECODE_H\n"]
+    out.append("#define POWERPC_DECODE_INSTRS %d\n" % len(table))
+    out.append("struct powerpc_decode_entry {\n  const char *name;\n  const char *format;\n"
+               "  unsigned int mask, match;      /* Decoder fields */\n"
+               "  unsigned int cycles;           /* set_cycles() */\n};\n")
+    out.append("static const powerpc_decode_entry powerpc_decode_table[POWERPC_DECODE_INSTRS] = {")
+    for name, fmt, mask, match, cycles in table:
+        out.append("  { %-10s %-7s 0x%08X, 0x%08X, %2d }," % ('"%s",' % name, '"%s",' % fmt, mask, match, cycles))
+    out.append("};\n")
+    out.append("//Second level of each primary opcode: index = (word >> shift) & mask")
+    out.append("struct powerpc_decode_level {\n  unsigned char shift;\n  unsigned short mask, base;\n};\n")
+    out.append("static const powerpc_decode_level powerpc_decode_level1[64] = {")
+    for opcd in range(0, 64, 4):
+        out.append("  " + " ".join("{ %2d, 0x%03X, %4d }," % level1[o] for o in range(opcd, opcd + 4)))
+    out.append("};\n")
+    out.append("static const unsigned char powerpc_decode_level2[%d] = {" % len(level2))
+    for i in range(0, len(level2), 16):
+        out.append("  " + " ".join("%3d," % x for x in level2[i:i + 16]))
+    out.append("};\n")
+    out.append("""//Instruction number of word, 0 if it is not a valid instruction
+inline unsigned int powerpc_decode(unsigned int word) {
+
+  const powerpc_decode_level &l = powerpc_decode_level1[word >> 26];
+  unsigned int i = powerpc_decode_level2[l.base + ((word >> l.shift) & l.mask)];
+
+  return (word & powerpc_decode_table[i].mask) == powerpc_decode_table[i].match ? i : 0;
+}
+
+#endif""")
+    return "\n".join(out) + "\n"
+
+
+def check(table, level1, level2, decoders):
+    """Every set_decoder() line decodes to its instruction whatever the
+    other bits hold, and words matching no set_decoder() line decode to 0.
+    The second check uses random words and words one bit away from each
+    decoder, compared with a linear search of the table."""
+    rnd = random.Random(2026)
+    for i, (name, fmt, mask, match, cycles) in enumerate(table):
+        if not i:
+            continue
+        for _ in range(256):
+            w = match | (rnd.getrandbits(32) & ~mask)
+            if decode(table, level1, level2, w) != i:
+                return "%s: 0x%08x decodes as %s" % (name, w, table[decode(table, level1, level2, w)][0])
+    words = [rnd.getrandbits(32) for _ in range(20000)]
+    for name, fmt, mask, match, cycles in table[1:]:
+        bits = [b for b in range(32) if mask >> b & 1]
+        for _ in range(64):
+            w = match | (rnd.getrandbits(32) & ~mask)
+            words.append(w ^ (1 << rnd.choice(bits)))
+    for w in words:
+        i = decode(table, level1, level2, w)
+        found = [k for k, t in enumerate(table) if k and (w & t[2]) == t[3]]
+        if not found and i:
+            return "0x%08x matches no set_decoder() line but decodes as %s" % (w, table[i][0])
+        if found and i not in found:
+            return "0x%08x matches %s but decodes as %s" % (w, table[found[0]][0], table[i][0])
+    if len(table) - 1 != len(decoders):
+        return "%d instructions declared, %d set_decoder() lines" % (len(table) - 1, len(decoders))
+    return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Generate powerpc_decode.H")
+    ap.add_argument("--check", action="store_true", help="verify powerpc_decode.H instead of writing it")
+    a = ap.parse_args()
+
+    table, level1, level2, decoders = build(ISA)
+    if len(table) > 256:
+        sys.exit("gen_decode: more than 255 instructions, widen powerpc_decode_level2")
+    error = check(table, level1, level2, decoders)
+    if error:
+        sys.exit("gen_decode: " + error)
+    text = write(table, level1, level2)
+
+    if a.check:
+        if not os.path.exists(OUT) or open(OUT).read() != text:
+            sys.exit("gen_decode: powerpc_decode.H is out of date, run tools/gen_decode.py")
+        print("gen_decode: %d instructions verified" % (len(table) - 1))
+        return
+    open(OUT, "w").write(text)
+
+
+if __name__ == "__main__":
+    main()